@@ -46,6 +46,7 @@
 
 #include <cstddef>
 #include <unordered_map>
+#include "utils/MemoryStatistic.h"
 #include "utils/printutils.h"
 
 template <class Key, class T>
@@ -67,6 +68,7 @@ class Cache
   Node *f, *l;
   void *unused{nullptr};
   size_t mx, total{0};
+  size_t evicted{0};
 
   inline void unlink(Node& n)
   {
@@ -75,6 +77,7 @@ class Cache
     if (l == &n) l = n.p;
     if (f == &n) f = n.n;
     total -= n.c;
+    MemoryStatistic::remove(MemoryStatistic::Category::Caches, n.c);
     T *obj = n.t;
     hash.erase(*n.keyPtr);
     delete obj;
@@ -108,6 +111,8 @@ public:
     trim(mx);
   }
   [[nodiscard]] inline size_t totalCost() const { return total; }
+  // Number of objects removed to make room for others, or by lowering the max cost
+  [[nodiscard]] inline size_t evictions() const { return evicted; }
 
   [[nodiscard]] inline size_t size() const { return hash.size(); }
   [[nodiscard]] inline bool empty() const { return hash.empty(); }
@@ -120,6 +125,7 @@ public:
     }
     hash.clear();
     l = nullptr;
+    MemoryStatistic::remove(MemoryStatistic::Category::Caches, total);
     total = 0;
   }
 
@@ -131,6 +137,13 @@ public:
   bool remove(const Key& key);
   T *take(const Key& key);
 
+  // Calls fn(key, object, cost) for each object, from the most to the least recently used
+  template <typename F>
+  void forEach(F fn) const
+  {
+    for (const Node *n = f; n; n = n->n) fn(*n->keyPtr, *n->t, n->c);
+  }
+
 private:
   void trim(size_t m);
 };
@@ -173,6 +186,7 @@ bool Cache<Key, T>::insert(const Key& akey, T *aobject, size_t acost)
   hash[akey] = node;
   auto i = hash.find(akey);
   total += acost;
+  MemoryStatistic::add(MemoryStatistic::Category::Caches, acost);
   Node *n = &i->second;
   n->keyPtr = &i->first;
   if (f) f->p = n;
@@ -193,5 +207,6 @@ void Cache<Key, T>::trim(size_t m)
     LOG("Trimming cache: %1$s (%2$d bytes)", u->keyPtr->substr(0, 40), u->c);
 #endif
     unlink(*u);
+    ++evicted;
   }
 }
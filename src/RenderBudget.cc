@@ -0,0 +1,146 @@
+#include "RenderBudget.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <boost/format.hpp>
+
+#include "core/ModuleInstantiation.h"
+#include "core/node.h"
+#include "geometry/GeometryCache.h"
+#include "io/fileutils.h"
+#include "io/ImportCache.h"
+#include "utils/MemoryStatistic.h"
+#include "utils/printutils.h"
+#ifdef ENABLE_CGAL
+#include "geometry/cgal/CGALCache.h"
+#endif
+
+#ifdef USE_MIMALLOC
+#include <mimalloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Reading the resident set size takes a system call on some platforms
+constexpr auto memoryCheckInterval = std::chrono::milliseconds(10);
+
+struct Budget {
+  RenderBudget::Limits limits;
+  std::string docPath;
+  std::thread::id thread = std::this_thread::get_id();
+  Clock::time_point start = Clock::now();
+  Clock::time_point nextMemoryCheck = start;
+  bool tracksGeometry = MemoryStatistic::tracksGeometry();  // Before the budget
+};
+
+std::unique_ptr<Budget> budget;
+
+size_t memoryUsed()
+{
+  const size_t rss = MemoryStatistic::process().live;
+  return rss > 0 ? rss : MemoryStatistic::total().live;
+}
+
+// Empties the caches and returns freed memory to the operating system, as far as
+// the allocator allows
+void shedCaches()
+{
+  GeometryCache::instance()->clear();
+#ifdef ENABLE_CGAL
+  CGALCache::instance()->clear();
+#endif
+  ImportCache::instance()->clear();
+#ifdef USE_MIMALLOC
+  mi_collect(true);
+#elif defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
+
+[[noreturn]] void exceeded(const char *resource, size_t limit, size_t used, const AbstractNode *node)
+{
+  RenderBudgetException e;
+  e.resource = resource;
+  e.limit = limit;
+  e.used = used;
+  if (node) {
+    e.node = node->name();
+    if (node->modinst && !node->modinst->location().isNone()) {
+      const auto& location = node->modinst->location();
+      e.location = fs_uncomplete(location.filePath(), budget->docPath).generic_string() + ":" +
+                   std::to_string(location.firstLine());
+    }
+  }
+  throw e;
+}
+
+}  // namespace
+
+RenderBudget::Scope::Scope(const Limits& limits, const std::string& docPath) : active(limits.any())
+{
+  if (!active) return;
+  budget = std::make_unique<Budget>();
+  budget->limits = limits;
+  budget->docPath = docPath;
+  // Without the resident set size, the accounted memory only includes geometry while it is tracked
+  if (limits.max_memory > 0 && MemoryStatistic::process().live == 0) {
+    MemoryStatistic::trackGeometry(true);
+  }
+}
+
+RenderBudget::Scope::~Scope()
+{
+  if (!active) return;
+  MemoryStatistic::trackGeometry(budget->tracksGeometry);
+  budget.reset();
+}
+
+bool RenderBudget::enabled()
+{
+  return budget && budget->thread == std::this_thread::get_id();
+}
+
+void RenderBudget::check(const AbstractNode *node)
+{
+  if (!enabled()) return;
+  const auto now = Clock::now();
+  const auto& limits = budget->limits;
+
+  if (limits.max_time > 0) {
+    const auto elapsed = std::chrono::duration<double>(now - budget->start).count();
+    if (elapsed > limits.max_time) {
+      exceeded("time", static_cast<size_t>(limits.max_time * 1000), static_cast<size_t>(elapsed * 1000),
+               node);
+    }
+  }
+
+  if (limits.max_memory > 0 && now >= budget->nextMemoryCheck) {
+    budget->nextMemoryCheck = now + memoryCheckInterval;
+    if (memoryUsed() <= limits.max_memory) return;
+    PRINTD("Memory budget exceeded, clearing caches");
+    shedCaches();
+    const size_t used = memoryUsed();
+    if (used > limits.max_memory) exceeded("memory", limits.max_memory, used, node);
+  }
+}
+
+std::string RenderBudgetException::message() const
+{
+  std::string where = node.empty() ? "during evaluation" : "rendering " + node + "()";
+  if (!location.empty()) where += " at " + location;
+  if (resource == "time") {
+    return (boost::format("Time limit of %.1f s exceeded %s") % (limit / 1000.0) % where).str();
+  }
+  return (boost::format("Memory limit of %d MB exceeded %s, using %d MB") % (limit >> 20) % where %
+          (used >> 20))
+    .str();
+}
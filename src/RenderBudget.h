@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "core/progress.h"
+
+class AbstractNode;
+
+/**
+ * Limits on the memory and time taken by evaluating and rendering one design.
+ *
+ * The budget is enforced cooperatively: evaluators call check() as they create
+ * contexts and finish nodes, as does progress_tick() during long geometry
+ * operations. When the process is over its memory limit, the geometry, CGAL and
+ * import caches are emptied first. If that doesn't bring memory below the limit,
+ * or the time is up, check() throws a RenderBudgetException, which unwinds like a
+ * cancellation by the user.
+ *
+ * Memory is the resident set size of the process, which MemoryStatistic measures on
+ * Linux, macOS and Windows. Elsewhere it is the memory accounted by MemoryStatistic,
+ * an estimate which counts geometry results while a memory limit is set. Only the
+ * thread which started the budget is checked, as the caches aren't shared between
+ * threads.
+ */
+class RenderBudget
+{
+public:
+  struct Limits {
+    size_t max_memory = 0;  // bytes, 0 for no limit
+    double max_time = 0;    // seconds, 0 for no limit
+    [[nodiscard]] bool any() const { return max_memory > 0 || max_time > 0; }
+  };
+
+  /**
+   * Enforces limits while in scope, if any are set. Locations of nodes which exceed
+   * the budget are reported relative to docPath.
+   */
+  class Scope
+  {
+  public:
+    Scope(const Limits& limits, const std::string& docPath);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    bool active;
+  };
+
+  [[nodiscard]] static bool enabled();
+
+  /**
+   * Sheds caches or throws RenderBudgetException if the budget is exceeded, naming
+   * node as the one which exceeded it. Cheap to call often, as the memory is only
+   * measured every few milliseconds.
+   */
+  static void check(const AbstractNode *node = nullptr);
+};
+
+/**
+ * Thrown by RenderBudget::check(). Derives from ProgressCancelException only, so it
+ * isn't swallowed by the handlers of geometry backends catching std::exception.
+ */
+class RenderBudgetException : public ProgressCancelException
+{
+public:
+  std::string resource;  // "memory" or "time"
+  size_t limit;          // bytes or milliseconds
+  size_t used;
+  std::string node;      // Name of the node being evaluated, empty during evaluation
+  std::string location;  // file:line of node relative to the document, if known
+
+  [[nodiscard]] std::string message() const;
+};
@@ -0,0 +1,288 @@
+#include "RenderProfiler.h"
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "json/json.hpp"
+
+#include "core/ModuleInstantiation.h"
+#include "core/node.h"
+#include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
+#include "io/fileutils.h"
+#include "utils/printutils.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// CPU time used by the calling thread, in microseconds. Falls back to the CPU
+// time of the whole process where that isn't available.
+int64_t threadCpuMicroseconds()
+{
+#if defined(_WIN32)
+  FILETIME creation, exit, kernel, user;
+  if (GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+    const auto ticks = [](const FILETIME& t) {
+      return (int64_t(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) / 10;  // 100ns ticks
+  }
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return int64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+  }
+#endif
+  return int64_t(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+}
+
+enum class CacheResult { None, Hit, Miss };
+
+struct Frame {
+  const char *evaluator;
+  const AbstractNode *node;
+  std::string location;
+  std::string label;
+  Clock::time_point start;
+  int64_t cpu_start_us;
+  int64_t children_us = 0;
+  size_t input_facets = 0;
+  size_t output_facets = 0;
+  const char *backend = nullptr;
+  CacheResult cache = CacheResult::None;
+};
+
+struct Event {
+  const char *evaluator;
+  std::string name;
+  std::string location;
+  int64_t start_us;
+  int64_t duration_us;
+  int64_t cpu_us;
+  size_t input_facets;
+  size_t output_facets;
+  const char *backend;
+  CacheResult cache;
+};
+
+struct Recording {
+  std::string docPath;
+  std::thread::id thread = std::this_thread::get_id();
+  Clock::time_point start = Clock::now();
+  std::vector<Frame> stack;
+  std::vector<Event> events;
+  // Self time in microseconds by ';' separated stack of frame labels
+  std::map<std::string, int64_t> folded;
+};
+
+std::unique_ptr<Recording> recording;
+
+bool isRecording()
+{
+  return recording && recording->thread == std::this_thread::get_id();
+}
+
+// The innermost recorded frame if it belongs to node, or nullptr
+Frame *currentFrame(const AbstractNode& node)
+{
+  if (!isRecording() || recording->stack.empty() || recording->stack.back().node != &node) {
+    return nullptr;
+  }
+  return &recording->stack.back();
+}
+
+int64_t microseconds(Clock::duration d)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+struct BackendVisitor : public GeometryVisitor {
+  void visit(const GeometryList& /*node*/) override { name = "list"; }
+  void visit(const PolySet& /*node*/) override { name = "PolySet"; }
+  void visit(const Polygon2d& /*node*/) override { name = "Clipper"; }
+#ifdef ENABLE_CGAL
+  void visit(const CGALNefGeometry& /*node*/) override { name = "CGAL"; }
+#endif
+#ifdef ENABLE_MANIFOLD
+  void visit(const ManifoldGeometry& /*node*/) override { name = "Manifold"; }
+#endif
+  const char *name = nullptr;
+};
+
+// The backend which produced geom, as far as can be told from its type
+const char *backendName(const Geometry& geom)
+{
+  // Visiting an instance would compute its transformed mesh
+  if (dynamic_cast<const InstancedGeometry *>(&geom)) return "PolySet";
+  BackendVisitor visitor;
+  geom.accept(visitor);
+  return visitor.name;
+}
+
+const char *cacheName(CacheResult cache)
+{
+  switch (cache) {
+  case CacheResult::Hit:  return "hit";
+  case CacheResult::Miss: return "miss";
+  default:                return "none";
+  }
+}
+
+std::string locationString(const AbstractNode& node)
+{
+  if (!node.modinst || node.modinst->location().isNone()) return {};
+  const auto& location = node.modinst->location();
+  return fs_uncomplete(location.filePath(), recording->docPath).generic_string() + ":" +
+         std::to_string(location.firstLine());
+}
+
+// Flamegraph tools split stacks at ';' and the count at the last space
+std::string frameLabel(const AbstractNode& node, const std::string& location)
+{
+  std::string label = node.name();
+  if (!location.empty()) label += "@" + location;
+  for (auto& c : label) {
+    if (c == ';' || c == ' ') c = '_';
+  }
+  return label;
+}
+
+std::filesystem::path foldedPath(const std::string& filename)
+{
+  auto path = std::filesystem::u8path(filename);
+  if (path.extension() == ".folded") return path += ".folded";
+  return path.replace_extension(".folded");
+}
+
+}  // namespace
+
+void RenderProfiler::start(const std::string& docPath)
+{
+  recording = std::make_unique<Recording>();
+  recording->docPath = docPath;
+}
+
+void RenderProfiler::discard() { recording.reset(); }
+
+bool RenderProfiler::enabled() { return recording != nullptr; }
+
+bool RenderProfiler::write(const std::string& filename)
+{
+  if (!recording) return false;
+  const auto done = std::move(recording);
+
+  nlohmann::json events = nlohmann::json::array();
+  for (const auto& event : done->events) {
+    nlohmann::json args = {
+      {"cpu_us", event.cpu_us},
+      {"input_facets", event.input_facets},
+      {"output_facets", event.output_facets},
+      {"cache", cacheName(event.cache)},
+    };
+    if (event.backend) args["backend"] = event.backend;
+    if (!event.location.empty()) args["location"] = event.location;
+    events.push_back({
+      {"name", event.name},
+      {"cat", event.evaluator},
+      {"ph", "X"},
+      {"ts", event.start_us},
+      {"dur", event.duration_us},
+      {"pid", 1},
+      {"tid", 1},
+      {"args", std::move(args)},
+    });
+  }
+  const nlohmann::json trace = {{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}};
+
+  std::ofstream tracestream(std::filesystem::u8path(filename));
+  tracestream << trace.dump(1) << "\n";
+  if (!tracestream) {
+    LOG(message_group::Error, "Can't write profile to '%1$s'", filename);
+    return false;
+  }
+
+  const auto folded = foldedPath(filename);
+  std::ofstream foldedstream(folded);
+  for (const auto& [stack, us] : done->folded) {
+    if (us > 0) foldedstream << stack << " " << us << "\n";
+  }
+  if (!foldedstream) {
+    LOG(message_group::Error, "Can't write profile to '%1$s'", folded.generic_string());
+    return false;
+  }
+  LOG("Profile of %1$d nodes written to %2$s and %3$s", done->events.size(), filename,
+      folded.generic_string());
+  return true;
+}
+
+RenderProfiler::NodeScope::NodeScope(const char *evaluator, const AbstractNode& node)
+  : recording(evaluator && isRecording())
+{
+  if (!this->recording) return;
+  auto location = locationString(node);
+  auto label = frameLabel(node, location);
+  ::recording->stack.push_back(
+    {evaluator, &node, std::move(location), std::move(label), Clock::now(), threadCpuMicroseconds()});
+}
+
+RenderProfiler::NodeScope::~NodeScope()
+{
+  // The profile may have been written while in scope
+  if (!this->recording || !::recording || ::recording->stack.empty()) return;
+  auto& rec = *::recording;
+  const auto end = Clock::now();
+  const int64_t cpu_end_us = threadCpuMicroseconds();
+  const auto& frame = rec.stack.back();
+
+  const int64_t duration_us = microseconds(end - frame.start);
+  std::string stack;
+  for (const auto& f : rec.stack) {
+    if (!stack.empty()) stack += ";";
+    stack += f.label;
+  }
+  rec.folded[stack] += duration_us - frame.children_us;
+
+  const int64_t cpu_us = cpu_end_us - frame.cpu_start_us;
+  rec.events.push_back({frame.evaluator, frame.node->name(), frame.location,
+                        microseconds(frame.start - rec.start), duration_us, cpu_us, frame.input_facets,
+                        frame.output_facets, frame.backend, frame.cache});
+
+  const auto *evaluator = frame.evaluator;
+  const auto output_facets = frame.output_facets;
+  rec.stack.pop_back();
+  if (!rec.stack.empty()) {
+    auto& parent = rec.stack.back();
+    parent.children_us += duration_us;
+    if (parent.evaluator == evaluator) parent.input_facets += output_facets;
+  }
+}
+
+void RenderProfiler::cacheHit(const AbstractNode& node)
+{
+  if (auto *frame = currentFrame(node)) frame->cache = CacheResult::Hit;
+}
+
+void RenderProfiler::result(const AbstractNode& node, const Geometry *geom)
+{
+  auto *frame = currentFrame(node);
+  if (!frame) return;
+  if (frame->cache == CacheResult::None) frame->cache = CacheResult::Miss;
+  if (geom) {
+    frame->output_facets = geom->numFacets();
+    frame->backend = backendName(*geom);
+  }
+}
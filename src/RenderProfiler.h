@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+
+class AbstractNode;
+class Geometry;
+
+/*!
+ * Records where rendering spends its time, per node of the tree.
+ *
+ * While enabled, every node traversed by an evaluator which names itself in
+ * NodeVisitor::profileName() is recorded with its wall time and the CPU time of
+ * its thread, the number of facets of its children and its result, the geometry
+ * backend of the result, whether the result came from the cache, and its source
+ * location. Nested
+ * traversals, like the GeometryEvaluator rendering a render() node for the
+ * CSGTreeEvaluator, show up as children of the node which started them.
+ *
+ * Only the thread which called start() is recorded.
+ */
+class RenderProfiler
+{
+public:
+  /*!
+   * Enable recording, discarding anything recorded earlier.
+   * Locations are reported relative to docPath.
+   */
+  static void start(const std::string& docPath);
+
+  /*!
+   * Stop recording, and write what was recorded as Chrome trace-event JSON to
+   * filename (for chrome://tracing or Perfetto), and as folded stacks of self time
+   * in microseconds (for flamegraph.pl or speedscope) to filename with its extension
+   * replaced by ".folded". Returns false if a file couldn't be written.
+   */
+  static bool write(const std::string& filename);
+
+  /*!
+   * Stop recording, discarding what was recorded.
+   */
+  static void discard();
+
+  [[nodiscard]] static bool enabled();
+
+  /*!
+   * Records while in scope if active is set. Anything not written by write() before
+   * leaving the scope, e.g. as rendering threw, is discarded.
+   */
+  class RecordingScope
+  {
+  public:
+    RecordingScope(const std::string& docPath, bool active)
+    {
+      if (active) start(docPath);
+    }
+    ~RecordingScope() { discard(); }
+    RecordingScope(const RecordingScope&) = delete;
+    RecordingScope& operator=(const RecordingScope&) = delete;
+  };
+
+  /*!
+   * Records the traversal of a node while in scope.
+   * Does nothing if the profiler is disabled or evaluator is nullptr.
+   */
+  class NodeScope
+  {
+  public:
+    NodeScope(const char *evaluator, const AbstractNode& node);
+    ~NodeScope();
+    NodeScope(const NodeScope&) = delete;
+    NodeScope& operator=(const NodeScope&) = delete;
+
+  private:
+    bool recording;
+  };
+
+  /*!
+   * Marks the innermost recorded node as served from the cache, if it is node.
+   */
+  static void cacheHit(const AbstractNode& node);
+
+  /*!
+   * Sets the result of the innermost recorded node, if it is node. Nodes with a
+   * result which weren't marked by cacheHit() are reported as cache misses.
+   */
+  static void result(const AbstractNode& node, const Geometry *geom);
+};
@@ -30,6 +30,7 @@
 #include <cassert>
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -39,12 +40,16 @@
 
 #include "json/json.hpp"
 
+#include "core/EvaluationProfiler.h"
 #include "geometry/Geometry.h"
+#include "geometry/CacheStatistic.h"
 #include "geometry/GeometryCache.h"
 #include "geometry/linalg.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/PolySet.h"
 #include "glview/Camera.h"
+#include "utils/cow_vector.h"
+#include "utils/MemoryStatistic.h"
 #include "utils/printutils.h"
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGALNefGeometry.h"
@@ -67,6 +72,8 @@ struct StatisticVisitor : public GeometryVisitor {
   virtual void printCamera(const Camera& camera) = 0;
   virtual void printCacheStatistic() = 0;
   virtual void printRenderingTime(std::chrono::milliseconds) = 0;
+  virtual void printEvaluationStatistic(const std::vector<EvaluationProfiler::Entry>& entries) = 0;
+  virtual void printMemoryStatistic() = 0;
   virtual void finish() = 0;
 
 protected:
@@ -94,6 +101,8 @@ struct LogVisitor : public StatisticVisitor {
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printEvaluationStatistic(const std::vector<EvaluationProfiler::Entry>& entries) override;
+  void printMemoryStatistic() override;
   void finish() override;
 
 private:
@@ -125,6 +134,8 @@ struct StreamVisitor : public StatisticVisitor {
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printEvaluationStatistic(const std::vector<EvaluationProfiler::Entry>& entries) override;
+  void printMemoryStatistic() override;
   void finish() override;
 
 private:
@@ -160,6 +171,11 @@ static nlohmann::json getBoundingBox3d(const Geometry& geometry)
   return bbJson;
 }
 
+nlohmann::json getCacheCounters(const CacheStatistic::Counters& counters)
+{
+  return {{"hits", counters.hits}, {"misses", counters.misses}, {"hit_ratio", counters.hitRatio()}};
+}
+
 template <typename C>
 static nlohmann::json getCache(C cache)
 {
@@ -167,6 +183,41 @@ static nlohmann::json getCache(C cache)
   cacheJson["entries"] = cache->size();
   cacheJson["bytes"] = cache->totalCost();
   cacheJson["max_size"] = cache->maxSizeMB() * 1024 * 1024;
+
+  const auto statistic = cache->statistic();
+  cacheJson.update(getCacheCounters(statistic.total));
+  cacheJson["inserts"] = statistic.inserts;
+  cacheJson["rejected"] = statistic.rejected;
+  cacheJson["evictions"] = statistic.evictions;
+  nlohmann::json byNodeType = nlohmann::json::object();
+  for (const auto& [type, counters] : statistic.byNodeType) {
+    byNodeType[type] = getCacheCounters(counters);
+  }
+  cacheJson["by_node_type"] = byNodeType;
+  cacheJson["bytes_by_geometry_type"] = statistic.bytesByGeometryType;
+  nlohmann::json ages = nlohmann::json::array();
+  for (size_t i = 0; i < statistic.entriesByAge.size(); ++i) {
+    nlohmann::json bucket = {{"entries", statistic.entriesByAge[i]}};
+    if (i < CacheStatistic::AGE_LIMITS.size()) bucket["max_seconds"] = CacheStatistic::AGE_LIMITS[i];
+    ages.push_back(bucket);
+  }
+  cacheJson["entries_by_age"] = ages;
+
+  // The keys are the node trees, so only their hashes are written
+  nlohmann::json contents = nlohmann::json::array();
+  const auto now = std::chrono::steady_clock::now();
+  cache->forEachEntry([&](const std::string& id, const CacheEntryInfo& info, size_t bytes) {
+    contents.push_back({
+      {"key_hash", (boost::format("%016x") % std::hash<std::string>{}(id)).str()},
+      {"node_type", info.nodeType},
+      {"geometry_type", info.geometryType},
+      {"bytes", bytes},
+      {"compute_seconds", info.computeSeconds},
+      {"age_seconds", std::chrono::duration<double>(now - info.inserted).count()},
+      {"hits", info.hits},
+    });
+  });
+  cacheJson["contents"] = contents;
   return cacheJson;
 }
 
@@ -190,7 +241,7 @@ std::chrono::milliseconds RenderStatistic::ms()
 
 void RenderStatistic::printCacheStatistic()
 {
-  LogVisitor visitor({});
+  LogVisitor visitor({RenderStatistic::CACHE});
   visitor.printCacheStatistic();
 }
 
@@ -220,6 +271,8 @@ void RenderStatistic::printAll(const std::shared_ptr<const Geometry>& geom, cons
     geom->accept(*visitor);
   }
   visitor->printCamera(camera);
+  visitor->printEvaluationStatistic(EvaluationProfiler::results());
+  visitor->printMemoryStatistic();
   visitor->finish();
 }
 
@@ -320,11 +373,12 @@ void LogVisitor::printCamera(const Camera& camera)
 
 void LogVisitor::printCacheStatistic()
 {
-  // always enabled
-  GeometryCache::instance()->print();
+  // always enabled, with details on request
+  GeometryCache::instance()->print(is_enabled(RenderStatistic::CACHE));
 #ifdef ENABLE_CGAL
-  CGALCache::instance()->print();
+  CGALCache::instance()->print(is_enabled(RenderStatistic::CACHE));
 #endif
+  LOG("Mesh storage currently shared by copies: %1$d bytes", CowStatistic::bytesShared());
 }
 
 void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
@@ -334,6 +388,41 @@ void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
       (ms.count() / 1000 / 60 % 60), (ms.count() / 1000 % 60), (ms.count() % 1000));
 }
 
+void LogVisitor::printEvaluationStatistic(const std::vector<EvaluationProfiler::Entry>& entries)
+{
+  if (is_enabled(RenderStatistic::EVALUATION)) {
+    constexpr size_t maxRows = 25;
+    LOG("Evaluation profile (by self time, %1$d of %2$d call sites):", std::min(entries.size(), maxRows),
+        entries.size());
+    LOG("   Self ms   Total ms      Calls    Allocs  Call");
+    for (size_t i = 0; i < entries.size() && i < maxRows; ++i) {
+      const auto& entry = entries[i];
+      const std::string location = entry.location.empty() ? "" : " (" + entry.location + ")";
+      LOG("%1$10.3f %2$10.3f %3$10d %4$9d  %5$s %6$s%7$s", entry.self_us / 1000.0,
+          entry.total_us / 1000.0, entry.calls, entry.self_allocations, entry.kind, entry.name,
+          location);
+    }
+  }
+}
+
+void LogVisitor::printMemoryStatistic()
+{
+  if (is_enabled(RenderStatistic::MEMORY)) {
+    constexpr double MB = 1024.0 * 1024.0;
+    const auto log = [MB](const char *name, const MemoryStatistic::Usage& usage) {
+      LOG("   %1$-16s %2$10.1f %3$10.1f", name, usage.live / MB, usage.peak / MB);
+    };
+    LOG("Memory (subsystems are estimated, the process is measured):");
+    LOG("   %1$-16s %2$10s %3$10s", "", "Live MB", "Peak MB");
+    for (size_t i = 0; i < MemoryStatistic::NUM_CATEGORIES; ++i) {
+      const auto category = static_cast<MemoryStatistic::Category>(i);
+      log(MemoryStatistic::name(category), MemoryStatistic::usage(category));
+    }
+    log("total", MemoryStatistic::total());
+    log("process (RSS)", MemoryStatistic::process());
+  }
+}
+
 void LogVisitor::finish()
 {
 }
@@ -432,6 +521,7 @@ void StreamVisitor::printCacheStatistic()
 #ifdef ENABLE_CGAL
     cacheJson["cgal_cache"] = getCache(CGALCache::instance());
 #endif  // ENABLE_CGAL
+    cacheJson["shared_mesh_bytes"] = CowStatistic::bytesShared();
     json["cache"] = cacheJson;
   }
 }
@@ -452,6 +542,43 @@ void StreamVisitor::printRenderingTime(const std::chrono::milliseconds ms)
   }
 }
 
+void StreamVisitor::printEvaluationStatistic(const std::vector<EvaluationProfiler::Entry>& entries)
+{
+  if (is_enabled(RenderStatistic::EVALUATION)) {
+    nlohmann::json evaluationJson = nlohmann::json::array();
+    for (const auto& entry : entries) {
+      evaluationJson.push_back({
+        {"kind", entry.kind},
+        {"name", entry.name},
+        {"location", entry.location},
+        {"calls", entry.calls},
+        {"total_us", entry.total_us},
+        {"self_us", entry.self_us},
+        {"total_allocations", entry.total_allocations},
+        {"self_allocations", entry.self_allocations},
+      });
+    }
+    json["evaluation"] = evaluationJson;
+  }
+}
+
+void StreamVisitor::printMemoryStatistic()
+{
+  if (is_enabled(RenderStatistic::MEMORY)) {
+    const auto usageJson = [](const MemoryStatistic::Usage& usage) {
+      return nlohmann::json{{"live_bytes", usage.live}, {"peak_bytes", usage.peak}};
+    };
+    nlohmann::json memoryJson;
+    for (size_t i = 0; i < MemoryStatistic::NUM_CATEGORIES; ++i) {
+      const auto category = static_cast<MemoryStatistic::Category>(i);
+      memoryJson[MemoryStatistic::name(category)] = usageJson(MemoryStatistic::usage(category));
+    }
+    memoryJson["total"] = usageJson(MemoryStatistic::total());
+    memoryJson["process"] = usageJson(MemoryStatistic::process());
+    json["memory"] = memoryJson;
+  }
+}
+
 void StreamVisitor::finish()
 {
   stream << json;
@@ -46,6 +46,8 @@ public:
   constexpr static auto GEOMETRY = "geometry";
   constexpr static auto BOUNDING_BOX = "bounding-box";
   constexpr static auto AREA = "area";
+  constexpr static auto EVALUATION = "evaluation";
+  constexpr static auto MEMORY = "memory";
 
   /**
    * Construct a statistic printer for the given geometry with current
@@ -65,7 +67,9 @@ public:
 
   /**
    * Print some statistic on cache usage. Namely, stats on the @ref GeometryCache
-   * and @ref CGALCache (if enabled).
+   * and @ref CGALCache (if enabled) including their hits by node type, bytes by
+   * geometry type and ages of entries (see @ref CacheStatistic), and the mesh
+   * storage shared by copies of PolySets (see @ref CowStatistic).
    */
   void printCacheStatistic();
 
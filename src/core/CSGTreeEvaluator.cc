@@ -1,4 +1,5 @@
 #include "core/CSGTreeEvaluator.h"
+#include "RenderProfiler.h"
 #include "geometry/Geometry.h"
 #include "geometry/linalg.h"
 #include "core/State.h"
@@ -11,10 +12,12 @@
 #include "core/CgalAdvNode.h"
 #include "utils/printutils.h"
 #include "geometry/GeometryEvaluator.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/PolySet.h"
 #include "geometry/PolySetBuilder.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <map>
 #include <list>
@@ -31,6 +34,8 @@
 
 std::shared_ptr<CSGNode> CSGTreeEvaluator::buildCSGTree(const AbstractNode& node)
 {
+  std::optional<GeometryEvaluator::PrefetchScope> prefetch;
+  if (this->geomevaluator) prefetch.emplace(*this->geomevaluator, node);
   this->traverse(node);
 
   std::shared_ptr<CSGNode> t(this->stored_term[node.index()]);
@@ -219,10 +224,16 @@ std::shared_ptr<CSGNode> CSGTreeEvaluator::evaluateCSGNodeFromGeometry(
   assert(geom);
   // We cannot render Polygon2d directly, so we convert it to a PolySet here
   std::shared_ptr<const PolySet> ps;
+  Transform3d matrix = state.matrix();
   if (!geom->isEmpty()) {
     if (auto p2d = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
       ps = polygon2dToPolySet(*p2d);
     }
+    // Instances are drawn from their shared mesh, using the leaf's matrix
+    else if (auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+      ps = instance->getBase();
+      matrix = matrix * instance->getMatrix();
+    }
     // 3D PolySets are tessellated before inserting into Geometry cache, inside
     // GeometryEvaluator::evaluateGeometry
     else {
@@ -231,7 +242,7 @@ std::shared_ptr<CSGNode> CSGTreeEvaluator::evaluateCSGNodeFromGeometry(
   }
 
   std::shared_ptr<CSGNode> t(
-    new CSGLeaf(ps, state.matrix(), state.color(), STR(node.name(), node.index()), node.index()));
+    new CSGLeaf(ps, matrix, state.color(), STR(node.name(), node.index()), node.index()));
   if (modinst->isHighlight() || state.isHighlight()) t->setHighlight(true);
   if (modinst->isBackground() || state.isBackground()) t->setBackground(true);
   return t;
@@ -242,7 +253,8 @@ Response CSGTreeEvaluator::visit(State& state, const AbstractPolyNode& node)
   if (state.isPostfix()) {
     std::shared_ptr<CSGNode> t1;
     if (this->geomevaluator) {
-      auto geom = this->geomevaluator->evaluateGeometry(node, false);
+      auto geom = this->geomevaluator->evaluateGeometry(node, false, true);
+      RenderProfiler::result(node, geom.get());
       if (geom) {
         t1 = evaluateCSGNodeFromGeometry(state, geom, node.modinst, node);
       } else {
@@ -301,7 +313,8 @@ Response CSGTreeEvaluator::visit(State& state, const RenderNode& node)
     std::shared_ptr<CSGNode> t1;
     std::shared_ptr<const Geometry> geom;
     if (this->geomevaluator) {
-      geom = this->geomevaluator->evaluateGeometry(node, false);
+      geom = this->geomevaluator->evaluateGeometry(node, false, true);
+      RenderProfiler::result(node, geom.get());
       if (geom) {
         t1 = evaluateCSGNodeFromGeometry(state, geom, node.modinst, node);
       } else {
@@ -322,7 +335,8 @@ Response CSGTreeEvaluator::visit(State& state, const CgalAdvNode& node)
     // FIXME: Calling evaluator directly since we're not a PolyNode. Generalize this.
     std::shared_ptr<const Geometry> geom;
     if (this->geomevaluator) {
-      geom = this->geomevaluator->evaluateGeometry(node, false);
+      geom = this->geomevaluator->evaluateGeometry(node, false, true);
+      RenderProfiler::result(node, geom.get());
       if (geom) {
         t1 = evaluateCSGNodeFromGeometry(state, geom, node.modinst, node);
       } else {
@@ -45,6 +45,7 @@ public:
   }
 
 private:
+  [[nodiscard]] const char *profileName() const override { return "CSGTreeEvaluator"; }
   void addToParent(const State& state, const AbstractNode& node);
   void applyToChildren(State& state, const AbstractNode& node, OpenSCADOperator op);
   std::shared_ptr<CSGNode> evaluateCSGNodeFromGeometry(State& state,
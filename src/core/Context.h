@@ -9,6 +9,7 @@
 #include "core/callables.h"
 #include "core/ContextFrame.h"
 #include "core/EvaluationSession.h"
+#include "RenderBudget.h"
 
 /**
  * Local handle to a all context objects. This is used to maintain the
@@ -24,6 +25,8 @@ public:
   {
     try {
       this->context->init();
+      // Checked here since addContext() runs in destructors, where throwing isn't possible
+      RenderBudget::check();
     } catch (...) {
       session->contextMemoryManager().addContext(std::move(this->context));
       throw;
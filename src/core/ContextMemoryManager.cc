@@ -361,9 +361,16 @@ ContextMemoryManager::~ContextMemoryManager()
   assert(heapSizeAccounting.size() == 0);
 }
 
+void ContextMemoryManager::releaseContext()
+{
+  heapSizeAccounting.removeContext();
+  trackedMemory.update(MemoryStatistic::Category::Values, heapSizeAccounting.size() * sizeof(Value));
+}
+
 void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
 {
   heapSizeAccounting.addContext();
+  trackedMemory.update(MemoryStatistic::Category::Values, heapSizeAccounting.size() * sizeof(Value));
   context->setAccountingAdded();  // avoiding bad accounting when an exception threw in constructor issue
                                   // #3871
 
@@ -387,6 +394,7 @@ void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
        * (i.e. waste is at most a factor 2 overhead).
        */
       nextGarbageCollectSize = heapSizeAccounting.size() * 2;
+      trackedMemory.update(MemoryStatistic::Category::Values, heapSizeAccounting.size() * sizeof(Value));
     }
   }
 }
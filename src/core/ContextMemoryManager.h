@@ -4,6 +4,8 @@
 #include <memory>
 #include <vector>
 
+#include "utils/MemoryStatistic.h"
+
 class Context;
 
 /*
@@ -18,17 +20,26 @@ class Context;
 class HeapSizeAccounting
 {
 public:
-  void addContext(size_t number = 1) { count += number; }
+  void addContext(size_t number = 1) { add(number); }
   void removeContext(size_t number = 1) { count -= number; }
-  void addContextVariable(size_t number = 1) { count += number; }
+  void addContextVariable(size_t number = 1) { add(number); }
   void removeContextVariable(size_t number = 1) { count -= number; }
-  void addVectorElement(size_t number = 1) { count += number; }
+  void addVectorElement(size_t number = 1) { add(number); }
   void removeVectorElement(size_t number = 1) { count -= number; }
 
   [[nodiscard]] size_t size() const { return count; }
+  // Points ever added, i.e. not reduced by removals
+  [[nodiscard]] size_t allocated() const { return total; }
 
 private:
+  void add(size_t number)
+  {
+    count += number;
+    total += number;
+  }
+
   size_t count = 0;
+  size_t total = 0;
 };
 
 class ContextMemoryManager
@@ -37,7 +48,7 @@ public:
   ~ContextMemoryManager();
 
   void addContext(const std::shared_ptr<Context>& context);
-  void releaseContext() { heapSizeAccounting.removeContext(); }
+  void releaseContext();
 
   HeapSizeAccounting& accounting() { return heapSizeAccounting; }
 
@@ -45,4 +56,6 @@ private:
   std::vector<std::weak_ptr<Context>> managedContexts;
   HeapSizeAccounting heapSizeAccounting;
   size_t nextGarbageCollectSize = 0;
+  // The accounted heap size, estimated as one Value per point
+  MemoryStatistic::Tracked trackedMemory;
 };
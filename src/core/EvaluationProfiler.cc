@@ -0,0 +1,123 @@
+#include "core/EvaluationProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/AST.h"
+#include "core/Context.h"
+#include "core/ContextMemoryManager.h"
+#include "core/EvaluationSession.h"
+#include "io/fileutils.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct CallSite {
+  EvaluationProfiler::Entry entry;
+  // Number of calls currently active, to count only the outermost of recursive calls in the total
+  size_t active = 0;
+};
+
+struct Call {
+  CallSite *site;
+  Clock::time_point start;
+  size_t allocated;
+  int64_t children_us = 0;
+  size_t children_allocations = 0;
+};
+
+struct Recording {
+  bool enabled = true;
+  std::unordered_map<const ASTNode *, CallSite> sites;
+  std::vector<Call> stack;
+};
+
+std::unique_ptr<Recording> recording;
+
+std::string locationString(const Location& location, const std::string& docPath)
+{
+  if (location.isNone()) return {};
+  return fs_uncomplete(location.filePath(), docPath).generic_string() + ":" +
+         std::to_string(location.firstLine());
+}
+
+}  // namespace
+
+void EvaluationProfiler::start()
+{
+  recording = std::make_unique<Recording>();
+}
+
+void EvaluationProfiler::stop()
+{
+  if (recording) recording->enabled = false;
+}
+
+bool EvaluationProfiler::enabled()
+{
+  return recording && recording->enabled;
+}
+
+std::vector<EvaluationProfiler::Entry> EvaluationProfiler::results()
+{
+  std::vector<Entry> entries;
+  if (!recording) return entries;
+  entries.reserve(recording->sites.size());
+  for (const auto& [callsite, site] : recording->sites) entries.push_back(site.entry);
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    if (a.self_us != b.self_us) return a.self_us > b.self_us;
+    return a.total_us > b.total_us;
+  });
+  return entries;
+}
+
+EvaluationProfiler::CallScope::CallScope(const char *kind, const ASTNode& callsite,
+                                         const std::string& name,
+                                         const std::shared_ptr<const Context>& context)
+{
+  if (!enabled()) return;
+  auto [it, inserted] = recording->sites.try_emplace(&callsite);
+  auto& site = it->second;
+  if (inserted) {
+    site.entry.kind = kind;
+    site.entry.name = name;
+    site.entry.location = locationString(callsite.location(), context->documentRoot());
+  }
+  ++site.entry.calls;
+  ++site.active;
+  this->accounting = &context->session()->accounting();
+  recording->stack.push_back({&site, Clock::now(), this->accounting->allocated()});
+}
+
+EvaluationProfiler::CallScope::~CallScope()
+{
+  // Results may have been discarded by start() while in scope
+  if (!this->accounting || !recording || recording->stack.empty()) return;
+  const auto& call = recording->stack.back();
+  const int64_t total_us =
+    std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - call.start).count();
+  const size_t allocations = this->accounting->allocated() - call.allocated;
+
+  auto& site = *call.site;
+  site.entry.self_us += total_us - call.children_us;
+  site.entry.self_allocations += allocations - call.children_allocations;
+  if (--site.active == 0) {
+    site.entry.total_us += total_us;
+    site.entry.total_allocations += allocations;
+  }
+
+  recording->stack.pop_back();
+  if (!recording->stack.empty()) {
+    auto& parent = recording->stack.back();
+    parent.children_us += total_us;
+    parent.children_allocations += allocations;
+  }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ASTNode;
+class Context;
+class HeapSizeAccounting;
+
+/*!
+   Attributes the time spent evaluating a script to the function calls and module
+   instantiations in its source.
+
+   While recording, each call site (a FunctionCall or ModuleInstantiation, whether
+   it calls a builtin or a user defined function or module) accumulates its number of
+   calls, and its total and self time and heap allocations. Self excludes the calls
+   made while it was active. Total only counts the outermost of recursive calls.
+
+   Allocations are counted in the points of HeapSizeAccounting, i.e. contexts,
+   context variables and vector elements.
+ */
+class EvaluationProfiler
+{
+public:
+  struct Entry {
+    std::string kind;  // "function" or "module"
+    std::string name;
+    std::string location;  // "file:line" relative to the document root
+    size_t calls = 0;
+    int64_t total_us = 0;
+    int64_t self_us = 0;
+    size_t total_allocations = 0;
+    size_t self_allocations = 0;
+  };
+
+  // Starts recording, discarding earlier results
+  static void start();
+  // Stops recording, keeping the results
+  static void stop();
+  [[nodiscard]] static bool enabled();
+  // Returns what was recorded, sorted by descending self time
+  [[nodiscard]] static std::vector<Entry> results();
+
+  /*!
+     Records while in scope if active is set, stopping even if evaluation throws.
+   */
+  class RecordingScope
+  {
+  public:
+    explicit RecordingScope(bool active) : active(active)
+    {
+      if (active) start();
+    }
+    ~RecordingScope()
+    {
+      if (active) stop();
+    }
+    RecordingScope(const RecordingScope&) = delete;
+    RecordingScope& operator=(const RecordingScope&) = delete;
+
+  private:
+    bool active;
+  };
+
+  /*!
+     Records a call of the given call site while in scope. Does nothing unless enabled.
+   */
+  class CallScope
+  {
+  public:
+    CallScope(const char *kind, const ASTNode& callsite, const std::string& name,
+              const std::shared_ptr<const Context>& context);
+    ~CallScope();
+    CallScope(const CallScope&) = delete;
+    CallScope& operator=(const CallScope&) = delete;
+
+  private:
+    HeapSizeAccounting *accounting = nullptr;
+  };
+};
@@ -41,6 +41,7 @@
 
 #include "Feature.h"
 #include "core/Context.h"
+#include "core/EvaluationProfiler.h"
 #include "core/EvaluationSession.h"
 #include "core/function.h"
 #include "core/Parameters.h"
@@ -590,6 +591,7 @@ Value FunctionCall::evaluate(const std::shared_ptr<const Context>& context) cons
     print_err(name.c_str(), loc, context);
     throw RecursionException::create("function", name, this->loc);
   }
+  const EvaluationProfiler::CallScope profile("function", *this, name, context);
 
   // Repeatedly simplify expr until it reduces to either a tail call,
   // or an expression that cannot be simplified in-place. If the latter,
@@ -7,6 +7,7 @@
 
 #include "utils/compiler_specific.h"
 #include "core/Context.h"
+#include "core/EvaluationProfiler.h"
 #include "core/Expression.h"
 #include "core/module.h"
 #include "utils/exceptions.h"
@@ -77,6 +78,7 @@ std::shared_ptr<AbstractNode> ModuleInstantiation::evaluate(
     return nullptr;
   }
 
+  const EvaluationProfiler::CallScope profile("module", *this, this->name(), context);
   try {
     auto node = module->module->instantiate(module->defining_context, this, context);
     return node;
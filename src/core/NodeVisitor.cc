@@ -1,10 +1,12 @@
 #include "core/NodeVisitor.h"
 #include "core/State.h"
+#include "RenderProfiler.h"
 
 State NodeVisitor::nullstate(nullptr);
 
 Response NodeVisitor::traverse(const AbstractNode& node, const State& state)
 {
+  const RenderProfiler::NodeScope profile(this->profileName(), node);
   State newstate = state;
   newstate.setNumChildren(node.getChildren().size());
 
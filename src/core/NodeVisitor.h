@@ -113,6 +113,10 @@ public:
   }
   // Add visit() methods for new visitable subtypes of AbstractNode here
 
+protected:
+  // Name under which traversed nodes are recorded by the RenderProfiler, or nullptr to not record them
+  [[nodiscard]] virtual const char *profileName() const { return nullptr; }
+
 private:
   static State nullstate;
 };
@@ -0,0 +1,193 @@
+#include "core/ProgressEstimator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <string>
+#include <utility>
+
+#include "core/node.h"
+
+namespace {
+
+using Operation = ProgressEstimator::Operation;
+
+// Facets guessed for leaves until they are rendered
+constexpr size_t LEAF_FACETS = 100;
+
+// Relative cost of the operations per input facet. Only a starting point, since
+// the seconds per unit of cost are learned for each operation while rendering.
+constexpr std::array<double, ProgressEstimator::NUM_OPERATIONS> WEIGHTS = {
+  1.0,   // Leaf
+  0.1,   // PassThrough
+  1.0,   // Union
+  1.0,   // Difference
+  1.0,   // Intersection
+  20.0,  // Minkowski
+  0.5,   // Hull
+  1.0,   // Extrusion
+  0.5,   // Other
+};
+
+double weight(Operation op)
+{
+  return WEIGHTS[static_cast<size_t>(op)];
+}
+
+// Booleans and most other operations grow slightly faster than linear in facets
+double operationCost(Operation op, size_t facets)
+{
+  const auto n = static_cast<double>(facets);
+  if (op == Operation::Leaf || op == Operation::PassThrough) return weight(op) * n;
+  return weight(op) * n * std::log2(n + 2);
+}
+
+}  // namespace
+
+ProgressEstimator::ProgressEstimator(const AbstractNode& root, TimeSource now)
+  : now(std::move(now)), start(this->now()), lastFinish(start)
+{
+  prepare(root, nullptr);
+}
+
+ProgressEstimator::Operation ProgressEstimator::operation(const AbstractNode& node)
+{
+  const auto& children = node.getChildren();
+  if (children.empty()) return Operation::Leaf;
+  const std::string name = node.name();
+  if (name == "union") return Operation::Union;
+  if (name == "difference") return Operation::Difference;
+  if (name == "intersection") return Operation::Intersection;
+  if (name == "minkowski") return Operation::Minkowski;
+  if (name == "hull") return Operation::Hull;
+  if (name == "linear_extrude" || name == "rotate_extrude" || name == "offset" ||
+      name == "projection" || name == "roof") {
+    return Operation::Extrusion;
+  }
+  if (name == "render" || name == "fill" || name == "resize") return Operation::Other;
+  // Lists hand their children to their parent
+  if (name == "list") return Operation::PassThrough;
+  // Groups, transformations and colors union their children
+  return children.size() > 1 ? Operation::Union : Operation::PassThrough;
+}
+
+// Adds entries for node and its descendants, returning the estimated facets of node
+size_t ProgressEstimator::prepare(const AbstractNode& node, Entry *parent)
+{
+  auto& entry = this->entries[&node];
+  entry.parent = parent;
+  entry.node = &node;
+  entry.op = operation(node);
+  for (const auto& child : node.getChildren()) {
+    entry.inputFacets += prepare(*child, &entry);
+  }
+  entry.outputFacets = entry.op == Operation::Leaf ? LEAF_FACETS : entry.inputFacets;
+  const size_t facets = entry.op == Operation::Leaf ? entry.outputFacets : entry.inputFacets;
+  setCost(entry, operationCost(entry.op, facets), 0);
+  return entry.outputFacets;
+}
+
+void ProgressEstimator::setCost(Entry& entry, double cost, double credit)
+{
+  auto& remaining = this->remainingCost[static_cast<size_t>(entry.op)];
+  if (!entry.done) remaining -= entry.cost * (1 - entry.credit);
+  entry.cost = cost;
+  entry.credit = credit;
+  if (!entry.done) remaining += entry.cost * (1 - entry.credit);
+}
+
+void ProgressEstimator::finish(Entry& entry, size_t facets, bool learn)
+{
+  const auto now = this->now();
+  setCost(entry, entry.cost, 1);
+  entry.done = true;
+  this->doneCost += entry.cost;
+  if (learn) {
+    const auto op = static_cast<size_t>(entry.op);
+    this->learnedCost[op] += entry.cost;
+    this->learnedSeconds[op] += std::chrono::duration<double>(now - this->lastFinish).count();
+    this->lastFinish = now;
+  }
+
+  if (auto *parent = entry.parent; parent && !parent->done) {
+    // The estimated output of parent stays as counted by its own parent until it finishes
+    parent->inputFacets = parent->inputFacets - entry.outputFacets + facets;
+    setCost(*parent, operationCost(parent->op, parent->inputFacets), parent->credit);
+  }
+  entry.outputFacets = facets;
+
+  // Descendants served from a cache are never rendered
+  for (const auto& child : entry.node->getChildren()) {
+    auto it = this->entries.find(child.get());
+    if (it != this->entries.end() && !it->second.done) {
+      finish(it->second, it->second.outputFacets, false);
+    }
+  }
+}
+
+void ProgressEstimator::finished(const AbstractNode& node, size_t facets)
+{
+  this->haveResults = true;
+  auto it = this->entries.find(&node);
+  if (it == this->entries.end() || it->second.done) return;
+  finish(it->second, facets, true);
+  it->second.firstReport = true;
+}
+
+void ProgressEstimator::reported(const AbstractNode& node)
+{
+  auto it = this->entries.find(&node);
+  if (it == this->entries.end()) return;
+  auto& entry = it->second;
+  if (!entry.done) {
+    // Results are only reported by some evaluators; the others report when done
+    if (!this->haveResults) finish(entry, entry.outputFacets, true);
+  } else if (entry.firstReport) {
+    entry.firstReport = false;
+  } else if (auto *parent = entry.parent; parent && !parent->done) {
+    const auto children = static_cast<double>(parent->node->getChildren().size());
+    setCost(*parent, parent->cost, std::min(0.95, parent->credit + 1 / children));
+  }
+}
+
+double ProgressEstimator::elapsed() const
+{
+  return std::chrono::duration<double>(this->now() - this->start).count();
+}
+
+// Seconds per unit of cost of op, leaning on the average over all operations until
+// op has been seen for a while
+double ProgressEstimator::rate(Operation op) const
+{
+  const double cost = std::accumulate(this->learnedCost.begin(), this->learnedCost.end(), 0.0);
+  const double seconds = std::accumulate(this->learnedSeconds.begin(), this->learnedSeconds.end(), 0.0);
+  const double average = seconds / cost;
+  const double prior = (this->doneCost + std::accumulate(this->remainingCost.begin(),
+                                                         this->remainingCost.end(), 0.0)) /
+                       static_cast<double>(this->entries.size());
+  const auto i = static_cast<size_t>(op);
+  return (this->learnedSeconds[i] + average * prior) / (this->learnedCost[i] + prior);
+}
+
+double ProgressEstimator::remaining() const
+{
+  if (std::accumulate(this->learnedCost.begin(), this->learnedCost.end(), 0.0) <= 0) return -1;
+  double seconds = 0;
+  for (size_t i = 0; i < NUM_OPERATIONS; ++i) {
+    if (this->remainingCost[i] > 0) seconds += this->remainingCost[i] * rate(static_cast<Operation>(i));
+  }
+  return seconds;
+}
+
+double ProgressEstimator::fraction() const
+{
+  const double left = remaining();
+  if (left >= 0) {
+    const double done = elapsed();
+    return done + left > 0 ? done / (done + left) : 1.0;
+  }
+  const double cost = std::accumulate(this->remainingCost.begin(), this->remainingCost.end(), 0.0);
+  return this->doneCost + cost > 0 ? this->doneCost / (this->doneCost + cost) : 0.0;
+}
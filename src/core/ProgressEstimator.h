@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+
+class AbstractNode;
+
+/*!
+   Estimates the progress and remaining time of rendering a node tree, weighting
+   nodes by the work of their operation instead of counting them.
+
+   The cost of a node is estimated from its operation and the facets of its
+   children. Before rendering, the facets of leaves are guessed, and those of other
+   nodes are the sum of their children. As nodes finish, their actual facets
+   replace the guess in the cost of their parent, and the time since the previous
+   node finished is attributed to the operation of the node, learning the seconds
+   per unit of cost of each operation. The remaining time is the remaining cost of
+   each operation at its learned rate.
+ */
+class ProgressEstimator
+{
+public:
+  enum class Operation {
+    Leaf,         // Primitives and imports
+    PassThrough,  // Transformations, and groups of one child
+    Union,        // Including implicit unions of groups
+    Difference,
+    Intersection,
+    Minkowski,
+    Hull,
+    Extrusion,  // Extrusions, offsets, projections and roofs
+    Other,
+  };
+  static constexpr size_t NUM_OPERATIONS = 9;
+
+  using Clock = std::chrono::steady_clock;
+  using TimeSource = std::function<Clock::time_point()>;
+
+  // Times are taken from now, which tests may replace
+  ProgressEstimator(const AbstractNode& root, TimeSource now = Clock::now);
+
+  // Records that node finished with a result of the given number of facets
+  void finished(const AbstractNode& node, size_t facets);
+
+  /*!
+     Records a progress report of node. Without results from finished(), the first
+     report finishes a node. Reports of a finished node after its first one come
+     from its parent merging it, and count as partial progress of the parent.
+   */
+  void reported(const AbstractNode& node);
+
+  // Seconds since construction
+  [[nodiscard]] double elapsed() const;
+  // Estimated seconds left, or a negative number while nothing has finished yet
+  [[nodiscard]] double remaining() const;
+  // Estimated share of the work done, in [0, 1]
+  [[nodiscard]] double fraction() const;
+
+  [[nodiscard]] static Operation operation(const AbstractNode& node);
+
+private:
+  struct Entry {
+    Entry *parent = nullptr;
+    const AbstractNode *node = nullptr;
+    Operation op = Operation::Leaf;
+    size_t inputFacets = 0;   // Sum of the outputs of the children
+    size_t outputFacets = 0;  // Estimated, or actual once finished
+    double cost = 0;
+    double credit = 0;  // Share of the cost done by merging children so far
+    bool done = false;
+    bool firstReport = false;  // The report following finished() is still to come
+  };
+
+  size_t prepare(const AbstractNode& node, Entry *parent);
+  void setCost(Entry& entry, double cost, double credit);
+  void finish(Entry& entry, size_t facets, bool learn);
+  [[nodiscard]] double rate(Operation op) const;
+
+  std::unordered_map<const AbstractNode *, Entry> entries;
+  std::array<double, NUM_OPERATIONS> remainingCost{};
+  std::array<double, NUM_OPERATIONS> learnedCost{};
+  std::array<double, NUM_OPERATIONS> learnedSeconds{};
+  double doneCost = 0;
+  bool haveResults = false;
+  TimeSource now;
+  Clock::time_point start;
+  Clock::time_point lastFinish;
+};
@@ -27,20 +27,22 @@
 #include "core/SurfaceNode.h"
 
 #include "geometry/PolySet.h"
-#include "geometry/PolySetBuilder.h"
 #include "core/Builtins.h"
 #include "core/Children.h"
 #include "core/module.h"
 #include "core/ModuleInstantiation.h"
 #include "core/node.h"
 #include "core/Parameters.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 #include "io/fileutils.h"
 #include "handle_dep.h"
 #include "lodepng/lodepng.h"
 
 #include <algorithm>
+#include <cctype>
 #include <cstring>
+#include <numeric>
 #include <new>
 #include <string>
 #include <utility>
@@ -50,10 +52,7 @@
 #include <sstream>
 #include <fstream>
 #include <vector>
-#include <unordered_map>
 
-#include <boost/functional/hash.hpp>
-#include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/assign/std/vector.hpp>
@@ -97,17 +96,22 @@ void SurfaceNode::convert_image(img_data_t& data, std::vector<uint8_t>& img, uns
   data.width = width;
   data.height = height;
   data.resize((size_t)width * height);
-  double min_val = 200;
-  for (unsigned int y = 0; y < height; ++y) {
+  std::vector<double> row_min(height, 200);
+  std::vector<unsigned int> rows(height);
+  std::iota(rows.begin(), rows.end(), 0);
+  parallelizable_for_each(rows.begin(), rows.end(), [&](unsigned int y) {
+    double min_val = 200;
     for (unsigned int x = 0; x < width; ++x) {
-      long idx = 4l * (y * width + x);
+      size_t idx = 4ul * ((size_t)y * width + x);
       double pixel = 0.2126 * img[idx] + 0.7152 * img[idx + 1] + 0.0722 * img[idx + 2];
       double z = 100.0 / 255 * (invert ? 1 - pixel : pixel);
-      data[x + (width * (height - 1 - y))] = z;
+      data.storage[x + ((size_t)width * (height - 1 - y))] = z;
       min_val = std::min(z, min_val);
     }
-  }
-  data.min_val = min_val;
+    row_min[y] = min_val;
+  });
+  data.min_val = std::accumulate(row_min.begin(), row_min.end(), 200.0,
+                                 [](double a, double b) { return std::min(a, b); });
 }
 
 bool SurfaceNode::is_png(std::vector<uint8_t>& png) const
@@ -163,139 +167,165 @@ img_data_t SurfaceNode::read_dat(std::string filename) const
     return data;
   }
 
-  int lines = 0, columns = 0;
+  size_t columns = 0;
   double min_val =
     1;  // this balances out with the (min_val-1) inside createGeometry, to match old behavior
 
-  using tokenizer = boost::tokenizer<boost::char_separator<char>>;
-  boost::char_separator<char> sep(" \t");
-
-  // We use an unordered map because the data file may not be rectangular,
-  // and we may need to fill in some bits.
-  using unordered_image_data_t =
-    std::unordered_map<std::pair<int, int>, double, boost::hash<std::pair<int, int>>>;
-  unordered_image_data_t unordered_data;
-
-  while (!stream.eof()) {
-    std::string line;
-    while (!stream.eof() && (line.size() == 0 || line[0] == '#')) {
-      std::getline(stream, line);
-      boost::trim(line);
-    }
-    if (line.size() == 0 && stream.eof()) break;
-
-    int col = 0;
-    tokenizer tokens(line, sep);
-    try {
-      for (const auto& token : tokens) {
-        auto v = boost::lexical_cast<double>(token);
-        unordered_data[std::make_pair(lines, col++)] = v;
-        if (col > columns) columns = col;
+  // Values are streamed into one flat vector; row_ends remembers where each line ends, since the
+  // data file may not be rectangular, and we may need to fill in some bits.
+  std::vector<double> values;
+  std::vector<size_t> row_ends;
+
+  std::string line;
+  while (std::getline(stream, line)) {
+    const char *p = line.c_str();
+    const char *end = p + line.size();
+    while (p != end && std::isspace(static_cast<unsigned char>(*p))) ++p;
+    if (p == end || *p == '#') continue;
+
+    const size_t row_start = values.size();
+    while (p != end) {
+      const char *token = p;
+      while (p != end && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+      if (p != token) {
+        double v;
+        if (!boost::conversion::try_lexical_convert(token, p - token, v)) {
+          if (!stream.eof()) {
+            LOG(message_group::Warning, "Illegal value in '%1$s': %2$s", filename,
+                boost::bad_lexical_cast().what());
+          }
+          return data;
+        }
+        values.push_back(v);
         min_val = std::min(v, min_val);
       }
-    } catch (const boost::bad_lexical_cast& blc) {
-      if (!stream.eof()) {
-        LOG(message_group::Warning, "Illegal value in '%1$s': %2$s", filename, blc.what());
-      }
-      return data;
+      while (p != end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
     }
-
-    lines++;
+    columns = std::max(columns, values.size() - row_start);
+    row_ends.push_back(values.size());
   }
 
+  const size_t lines = row_ends.size();
   data.width = columns;
   data.height = lines;
   data.min_val = min_val;
 
-  // Now convert the unordered, possibly non-rectangular data into a well ordered vector
-  // for faster access and reduced memory usage.
-  data.resize((size_t)lines * columns);
-  for (int i = 0; i < lines; ++i)
-    for (int j = 0; j < columns; ++j) data[i * columns + j] = unordered_data[std::make_pair(i, j)];
+  if (values.size() == lines * columns) {
+    data.storage = std::move(values);
+  } else {
+    // Pad short lines with zeros
+    data.resize(lines * columns);
+    size_t row_start = 0;
+    for (size_t i = 0; i < lines; ++i) {
+      std::copy(values.begin() + row_start, values.begin() + row_ends[i],
+                data.storage.begin() + i * columns);
+      row_start = row_ends[i];
+    }
+  }
 
   return data;
 }
 
-// FIXME: Look for faster way to generate PolySet directly
 std::unique_ptr<const Geometry> SurfaceNode::createGeometry() const
 {
   auto data = read_png_or_dat(filename);
 
-  int lines = data.height;
-  int columns = data.width;
-  double min_val = data.min_value() - 1;  // make the bottom solid, and match old code
-
-  // reserve the polygon vector size so we don't have to reallocate as often
-
-  double ox = center ? -(columns - 1) / 2.0 : 0;
-  double oy = center ? -(lines - 1) / 2.0 : 0;
-
-  int num_indices = (lines - 1) * (columns - 1) * 4 + (lines - 1) * 2 + (columns - 1) * 2 + 1;
-  PolySetBuilder builder(0, num_indices);
-  builder.setConvexity(convexity);
-  // the bulk of the heightmap
-  for (int i = 1; i < lines; ++i)
-    for (int j = 1; j < columns; ++j) {
-      double v1 = data[(j - 1) + (i - 1) * columns];
-      double v2 = data[(j) + (i - 1) * columns];
-      double v3 = data[(j - 1) + (i)*columns];
-      double v4 = data[(j) + (i)*columns];
-
-      double vx = (v1 + v2 + v3 + v4) / 4;
-
-      builder.appendPolygon({Vector3d(ox + j - 1, oy + i - 1, v1), Vector3d(ox + j, oy + i - 1, v2),
-                             Vector3d(ox + j - 0.5, oy + i - 0.5, vx)});
-
-      builder.appendPolygon({Vector3d(ox + j, oy + i - 1, v2), Vector3d(ox + j, oy + i, v4),
-                             Vector3d(ox + j - 0.5, oy + i - 0.5, vx)});
-
-      builder.appendPolygon({Vector3d(ox + j, oy + i, v4), Vector3d(ox + j - 1, oy + i, v3),
-                             Vector3d(ox + j - 0.5, oy + i - 0.5, vx)});
-
-      builder.appendPolygon({Vector3d(ox + j - 1, oy + i, v3), Vector3d(ox + j - 1, oy + i - 1, v1),
-                             Vector3d(ox + j - 0.5, oy + i - 0.5, vx)});
+  const size_t lines = data.height;
+  const size_t columns = data.width;
+  const double min_val = data.min_value() - 1;  // make the bottom solid, and match old code
+
+  auto ps = std::make_unique<PolySet>(3);
+  ps->setConvexity(convexity);
+  if (lines < 2 && columns < 2) return ps;
+
+  const double ox = center ? -(columns - 1) / 2.0 : 0;
+  const double oy = center ? -(lines - 1) / 2.0 : 0;
+
+  // The grid topology is known, so vertex indices are computed rather than looked up:
+  // the heightmap grid, the center of each cell, and the bottom outline (at min_val).
+  const size_t cells = (lines - 1) * (columns - 1);
+  const size_t center_base = lines * columns;
+  const size_t bottom_base = center_base + cells;
+  // Bottom vertices along the left and right edges (x = 0 and x = columns - 1), then the
+  // remaining ones along the front and back edges (y = 0 and y = lines - 1).
+  const size_t side_count = columns > 1 ? 2 : 1;
+  const size_t inner_columns = columns > 2 ? columns - 2 : 0;
+  const size_t end_count = lines > 1 ? 2 : 1;
+  const auto bottom = [&](size_t x, size_t y) -> int {
+    if (x == 0 || x == columns - 1) {
+      return bottom_base + (x == 0 ? 0 : side_count - 1) * lines + y;
     }
+    return bottom_base + side_count * lines + (y == 0 ? 0 : end_count - 1) * inner_columns + x - 1;
+  };
+  const auto top = [&](size_t x, size_t y) -> int { return y * columns + x; };
+  const auto middle = [&](size_t x, size_t y) -> int { return center_base + y * (columns - 1) + x; };
+
+  // Taken once, as element access through the copy-on-write arrays checks for sharing
+  auto& vertices = ps->vertices.mut();
+  auto& indices = ps->indices.mut();
+  vertices.resize(bottom_base + side_count * lines + end_count * inner_columns);
+  const bool has_bottom = columns > 1 && lines > 1;
+  indices.resize(4 * cells + 2 * (lines - 1) + 2 * (columns - 1) + (has_bottom ? 1 : 0));
+
+  // the bulk of the heightmap, in parallel row strips
+  std::vector<size_t> rows(lines);
+  std::iota(rows.begin(), rows.end(), 0);
+  parallelizable_for_each(rows.begin(), rows.end(), [&](size_t i) {
+    for (size_t j = 0; j < columns; ++j) {
+      vertices[top(j, i)] = Vector3d(ox + j, oy + i, data.storage[j + i * columns]);
+    }
+    if (i == 0) return;
+    for (size_t j = 1; j < columns; ++j) {
+      const double v1 = data.storage[(j - 1) + (i - 1) * columns];
+      const double v2 = data.storage[(j) + (i - 1) * columns];
+      const double v3 = data.storage[(j - 1) + (i)*columns];
+      const double v4 = data.storage[(j) + (i)*columns];
+      const double vx = (v1 + v2 + v3 + v4) / 4;
+      const int c = middle(j - 1, i - 1);
+      vertices[c] = Vector3d(ox + j - 0.5, oy + i - 0.5, vx);
+
+      auto *faces = &indices[4 * ((i - 1) * (columns - 1) + (j - 1))];
+      faces[0] = {top(j - 1, i - 1), top(j, i - 1), c};
+      faces[1] = {top(j, i - 1), top(j, i), c};
+      faces[2] = {top(j, i), top(j - 1, i), c};
+      faces[3] = {top(j - 1, i), top(j - 1, i - 1), c};
+    }
+  });
+
+  for (size_t i = 0; i < lines; ++i) {
+    vertices[bottom(0, i)] = Vector3d(ox + 0, oy + i, min_val);
+    vertices[bottom(columns - 1, i)] = Vector3d(ox + columns - 1, oy + i, min_val);
+  }
+  for (size_t i = 1; i + 1 < columns; ++i) {
+    vertices[bottom(i, 0)] = Vector3d(ox + i, oy + 0, min_val);
+    vertices[bottom(i, lines - 1)] = Vector3d(ox + i, oy + lines - 1, min_val);
+  }
 
+  auto face = indices.begin() + 4 * cells;
   // edges along Y
-  for (int i = 1; i < lines; ++i) {
-    double v1 = data[(0) + (i - 1) * columns];
-    double v2 = data[(0) + (i)*columns];
-    double v3 = data[(columns - 1) + (i - 1) * columns];
-    double v4 = data[(columns - 1) + (i)*columns];
-
-    builder.appendPolygon({Vector3d(ox + 0, oy + i - 1, min_val), Vector3d(ox + 0, oy + i - 1, v1),
-                           Vector3d(ox + 0, oy + i, v2), Vector3d(ox + 0, oy + i, min_val)});
-
-    builder.appendPolygon(
-      {Vector3d(ox + columns - 1, oy + i, min_val), Vector3d(ox + columns - 1, oy + i, v4),
-       Vector3d(ox + columns - 1, oy + i - 1, v3), Vector3d(ox + columns - 1, oy + i - 1, min_val)});
+  for (size_t i = 1; i < lines; ++i) {
+    *face++ = {bottom(0, i - 1), top(0, i - 1), top(0, i), bottom(0, i)};
+    *face++ = {bottom(columns - 1, i), top(columns - 1, i), top(columns - 1, i - 1),
+               bottom(columns - 1, i - 1)};
   }
 
   // edges along X
-  for (int i = 1; i < columns; ++i) {
-    double v1 = data[(i - 1) + (0) * columns];
-    double v2 = data[(i) + (0) * columns];
-    double v3 = data[(i - 1) + (lines - 1) * columns];
-    double v4 = data[(i) + (lines - 1) * columns];
-
-    builder.appendPolygon({Vector3d(ox + i, oy + 0, min_val), Vector3d(ox + i, oy + 0, v2),
-                           Vector3d(ox + i - 1, oy + 0, v1), Vector3d(ox + i - 1, oy + 0, min_val)});
-
-    builder.appendPolygon(
-      {Vector3d(ox + i - 1, oy + lines - 1, min_val), Vector3d(ox + i - 1, oy + lines - 1, v3),
-       Vector3d(ox + i, oy + lines - 1, v4), Vector3d(ox + i, oy + lines - 1, min_val)});
+  for (size_t i = 1; i < columns; ++i) {
+    *face++ = {bottom(i, 0), top(i, 0), top(i - 1, 0), bottom(i - 1, 0)};
+    *face++ = {bottom(i - 1, lines - 1), top(i - 1, lines - 1), top(i, lines - 1), bottom(i, lines - 1)};
   }
 
   // the bottom of the shape (one less than the real minimum value), making it a solid volume
-  if (columns > 1 && lines > 1) {
-    builder.beginPolygon(2 * (columns - 1) + 2 * (lines - 1));
-    for (int i = 0; i < lines - 1; ++i) builder.addVertex(Vector3d(ox + 0, oy + i, min_val));
-    for (int i = 0; i < columns - 1; ++i) builder.addVertex(Vector3d(ox + i, oy + lines - 1, min_val));
-    for (int i = lines - 1; i > 0; i--) builder.addVertex(Vector3d(ox + columns - 1, oy + i, min_val));
-    for (int i = columns - 1; i > 0; i--) builder.addVertex(Vector3d(ox + i, oy + 0, min_val));
+  if (has_bottom) {
+    face->reserve(2 * (columns - 1) + 2 * (lines - 1));
+    for (size_t i = 0; i < lines - 1; ++i) face->push_back(bottom(0, i));
+    for (size_t i = 0; i < columns - 1; ++i) face->push_back(bottom(i, lines - 1));
+    for (size_t i = lines - 1; i > 0; i--) face->push_back(bottom(columns - 1, i));
+    for (size_t i = columns - 1; i > 0; i--) face->push_back(bottom(i, 0));
   }
 
-  return builder.build();
+  ps->setTriangular(false);
+  return ps;
 }
 
 std::string SurfaceNode::toString() const
@@ -0,0 +1,82 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/AST.h"
+#include "core/Context.h"
+#include "core/EvaluationSession.h"
+#include "core/Value.h"
+
+TEST_CASE("Value arithmetic", "[.][benchmark][Value]")
+{
+  EvaluationSession session{"."};
+
+  BENCHMARK("Value scalar arithmetic")
+  {
+    Value sum(0.0);
+    for (int i = 0; i < 1000; ++i) sum = sum + Value(double(i)) * Value(0.5);
+    return sum.toDouble();
+  };
+
+  Value::VectorType a(&session), b(&session);
+  for (int i = 0; i < 1000; ++i) {
+    a.emplace_back(double(i));
+    b.emplace_back(double(i) * 2);
+  }
+  const Value va(std::move(a)), vb(std::move(b));
+
+  BENCHMARK("Value vector addition") { return va + vb; };
+  BENCHMARK("Value vector dot product") { return va * vb; };
+}
+
+namespace {
+
+// Calls f with the innermost of depth nested scopes below parent
+template <typename F>
+void withNestedScopes(const std::shared_ptr<const Context>& parent, int depth, F&& f)
+{
+  ContextHandle<Context> scope{Context::create<Context>(parent)};
+  if (depth > 1) withNestedScopes(*scope, depth - 1, std::forward<F>(f));
+  else f(scope);
+}
+
+}  // namespace
+
+TEST_CASE("Context variable lookup", "[.][benchmark][Context]")
+{
+  EvaluationSession session{"."};
+  ContextHandle<Context> root{Context::create<Context>(&session)};
+  std::vector<std::string> names;
+  for (int i = 0; i < 100; ++i) {
+    names.push_back("var" + std::to_string(i));
+    root->set_variable(names.back(), Value(double(i)));
+  }
+
+  // Lookups from a deeply nested scope, as in recursive modules and functions
+  withNestedScopes(*root, 50, [&](ContextHandle<Context>& scope) {
+    scope->set_variable("local", Value(1.0));
+
+    BENCHMARK("Context lookup of local variable")
+    {
+      double sum = 0;
+      for (size_t i = 0; i < names.size(); ++i) {
+        sum += scope->lookup_variable("local", Location::NONE).toDouble();
+      }
+      return sum;
+    };
+    BENCHMARK("Context lookup through 50 scopes")
+    {
+      double sum = 0;
+      for (const auto& name : names) sum += scope->lookup_variable(name, Location::NONE).toDouble();
+      return sum;
+    };
+    BENCHMARK("Context lookup of special variable")
+    {
+      return scope->try_lookup_variable("$fn").has_value();
+    };
+  });
+}
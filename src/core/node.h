@@ -11,6 +11,7 @@
 #include "core/BaseVisitable.h"
 #include "core/AST.h"
 #include "core/ModuleInstantiation.h"
+#include "utils/MemoryStatistic.h"
 
 extern int progress_report_count;
 extern void (*progress_report_f)(const std::shared_ptr<const AbstractNode>&, void *, int);
@@ -65,6 +66,9 @@ public:
 
   int idx;  // Node index (unique per tree)
 
+  // Estimated size of the node; nodes holding large data, like polyhedron(), update it
+  MemoryStatistic::Tracked trackedMemory{MemoryStatistic::Category::NodeTree, sizeof(AbstractNode)};
+
   std::shared_ptr<const AbstractNode> getNodeByID(
     int idx, std::deque<std::shared_ptr<const AbstractNode>>& path) const;
 
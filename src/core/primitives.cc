@@ -38,6 +38,7 @@
 #include "core/Parameters.h"
 #include "utils/calc.h"
 #include "utils/degree_trig.h"
+#include "utils/MemoryStatistic.h"
 #include "utils/printutils.h"
 #include <algorithm>
 #include <utility>
@@ -494,6 +495,9 @@ static std::shared_ptr<AbstractNode> builtin_polyhedron(const ModuleInstantiatio
   node->convexity = (int)parameters["convexity"].toDouble();
   if (node->convexity < 1) node->convexity = 1;
 
+  size_t bytes = sizeof(PolyhedronNode) + node->points.size() * sizeof(Vector3d);
+  for (const auto& face : node->faces) bytes += sizeof(face) + face.size() * sizeof(int);
+  node->trackedMemory.update(MemoryStatistic::Category::NodeTree, bytes);
   return node;
 }
 
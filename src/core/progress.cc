@@ -2,11 +2,15 @@
 
 #include <memory>
 #include "core/node.h"
+#include "core/ProgressEstimator.h"
+#include "geometry/Geometry.h"
+#include "RenderBudget.h"
 
 int progress_report_count;
 int progress_mark_;
 void (*progress_report_f)(const std::shared_ptr<const AbstractNode>&, void *, int);
 void *progress_report_userdata;
+std::unique_ptr<ProgressEstimator> progress_estimator;
 
 void progress_report_prep(const std::shared_ptr<AbstractNode>& root,
                           void (*f)(const std::shared_ptr<const AbstractNode>& node, void *userdata,
@@ -17,6 +21,7 @@ void progress_report_prep(const std::shared_ptr<AbstractNode>& root,
   progress_report_f = f;
   progress_report_userdata = userdata;
   root->progress_prepare();
+  progress_estimator = std::make_unique<ProgressEstimator>(*root);
 }
 
 void progress_report_fin()
@@ -24,11 +29,13 @@ void progress_report_fin()
   progress_report_count = 0;
   progress_report_f = nullptr;
   progress_report_userdata = nullptr;
+  progress_estimator.reset();
 }
 
 void progress_update(const std::shared_ptr<const AbstractNode>& node, int mark)
 {
   if (progress_report_f) {
+    if (node && progress_estimator) progress_estimator->reported(*node);
     progress_mark_ = mark;
     progress_report_f(node, progress_report_userdata, progress_mark_);
   }
@@ -36,6 +43,19 @@ void progress_update(const std::shared_ptr<const AbstractNode>& node, int mark)
 
 void progress_tick()
 {
+  RenderBudget::check();
   if (progress_report_f)
     progress_report_f(std::shared_ptr<const AbstractNode>(), progress_report_userdata, ++progress_mark_);
 }
+
+void progress_result(const AbstractNode& node, const Geometry *geom)
+{
+  if (progress_estimator) progress_estimator->finished(node, geom ? geom->numFacets() : 0);
+}
+
+ProgressEstimate progress_estimate()
+{
+  if (!progress_estimator) return {};
+  const auto& estimator = *progress_estimator;
+  return {estimator.fraction(), estimator.elapsed(), estimator.remaining()};
+}
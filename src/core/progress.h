@@ -3,6 +3,7 @@
 #include <memory>
 
 class AbstractNode;
+class Geometry;
 
 // Reset to 0 in _prep() and increased for each Node instance in progress_prepare()
 extern int progress_report_count;
@@ -20,6 +21,18 @@ void progress_update(const std::shared_ptr<const AbstractNode>& node, int mark);
 // exact node
 void progress_tick();
 
+// Reports the result of a finished node, refining the estimates of progress_estimate()
+void progress_result(const AbstractNode& node, const Geometry *geom);
+
+struct ProgressEstimate {
+  double fraction = 0;    // Estimated share of the work done, in [0, 1]
+  double elapsed = 0;     // Seconds since progress_report_prep()
+  double remaining = -1;  // Estimated seconds left, negative if not known yet
+};
+
+// Progress weighted by the estimated cost of nodes, see ProgressEstimator
+ProgressEstimate progress_estimate();
+
 class ProgressCancelException
 {
 };
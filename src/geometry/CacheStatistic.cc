@@ -0,0 +1,56 @@
+#include "geometry/CacheStatistic.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "utils/printutils.h"
+
+void CacheStatistic::hit(const std::string& nodeType)
+{
+  ++this->total.hits;
+  ++this->byNodeType[nodeType].hits;
+}
+
+void CacheStatistic::miss(const std::string& nodeType)
+{
+  ++this->total.misses;
+  ++this->byNodeType[nodeType].misses;
+}
+
+void CacheStatistic::addEntry(const CacheEntryInfo& info, size_t bytes,
+                              std::chrono::steady_clock::time_point now)
+{
+  this->bytesByGeometryType[info.geometryType] += bytes;
+  const double age = std::chrono::duration<double>(now - info.inserted).count();
+  size_t bucket = 0;
+  while (bucket < AGE_LIMITS.size() && age >= AGE_LIMITS[bucket]) ++bucket;
+  ++this->entriesByAge[bucket];
+}
+
+void CacheStatistic::print(const std::string& name, bool details) const
+{
+  LOG("%1$s: %2$d hits, %3$d misses (%4$.1f%% hit ratio), %5$d inserts, %6$d rejected, %7$d evictions",
+      name, this->total.hits, this->total.misses, 100 * this->total.hitRatio(), this->inserts,
+      this->rejected, this->evictions);
+  if (!details) return;
+  if (!this->byNodeType.empty()) {
+    std::string types;
+    for (const auto& [type, counters] : this->byNodeType) {
+      if (!types.empty()) types += ", ";
+      types += STR(type, " ", counters.hits, "/", counters.hits + counters.misses);
+    }
+    LOG("%1$s hits by node type: %2$s", name, types);
+  }
+  if (!this->bytesByGeometryType.empty()) {
+    std::string types;
+    for (const auto& [type, bytes] : this->bytesByGeometryType) {
+      if (!types.empty()) types += ", ";
+      types += STR(type, " ", bytes);
+    }
+    LOG("%1$s bytes by geometry type: %2$s", name, types);
+  }
+  const auto& e = this->entriesByAge;
+  LOG("%1$s entries by age: <1s %2$d, <10s %3$d, <1m %4$d, <10m %5$d, <1h %6$d, older %7$d", name, e[0],
+      e[1], e[2], e[3], e[4], e[5]);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+
+#include "Cache.h"
+
+/*!
+   What the geometry caches know about each of their entries.
+ */
+struct CacheEntryInfo {
+  std::string nodeType;       // Name of the node which produced the geometry, e.g. "difference"
+  std::string geometryType;   // See Geometry::typeName()
+  double computeSeconds = 0;  // Wall time of computing the geometry, including its children
+  std::chrono::steady_clock::time_point inserted = std::chrono::steady_clock::now();
+  size_t hits = 0;
+};
+
+/*!
+   Counters of a geometry cache, and a summary of its entries, for tuning cache sizes.
+
+   A miss is a result which wasn't found in any cache, so it was computed and offered
+   to this cache. Hits and misses are also counted by the type of node producing the
+   result.
+ */
+struct CacheStatistic {
+  struct Counters {
+    size_t hits = 0;
+    size_t misses = 0;
+    [[nodiscard]] double hitRatio() const
+    {
+      return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+    }
+  };
+
+  // Upper bounds in seconds of the age buckets, the last bucket holds older entries
+  static constexpr std::array<double, 5> AGE_LIMITS = {1, 10, 60, 600, 3600};
+
+  Counters total;
+  std::map<std::string, Counters> byNodeType;
+  size_t inserts = 0;
+  size_t rejected = 0;  // Too large for the cache
+  size_t evictions = 0;
+
+  // Summary of the entries at the time of the snapshot
+  std::map<std::string, size_t> bytesByGeometryType;
+  std::array<size_t, AGE_LIMITS.size() + 1> entriesByAge{};
+
+  void hit(const std::string& nodeType);
+  void miss(const std::string& nodeType);
+  void addEntry(const CacheEntryInfo& info, size_t bytes, std::chrono::steady_clock::time_point now);
+
+  // Logs the counters, and the counters by type and the summary of entries if details
+  // is set, naming the cache as e.g. "Geometry cache"
+  void print(const std::string& name, bool details) const;
+};
+
+using CacheEntryFunc =
+  std::function<void(const std::string& id, const CacheEntryInfo& info, size_t bytes)>;
+
+/*!
+   The counters of a geometry cache, with the evictions and a summary of the entries of
+   cache. Entry is the cache's entry type, which keeps its CacheEntryInfo in info.
+ */
+template <typename Entry>
+CacheStatistic cacheStatistic(const Cache<std::string, Entry>& cache, const CacheStatistic& counters)
+{
+  CacheStatistic statistic = counters;
+  statistic.evictions = cache.evictions();
+  const auto now = std::chrono::steady_clock::now();
+  cache.forEach([&](const std::string& /*id*/, const Entry& entry, size_t bytes) {
+    statistic.addEntry(entry.info, bytes, now);
+  });
+  return statistic;
+}
+
+// Calls f for each entry of cache, from the most to the least recently used
+template <typename Entry>
+void forEachCacheEntry(const Cache<std::string, Entry>& cache, const CacheEntryFunc& f)
+{
+  cache.forEach(
+    [&](const std::string& id, const Entry& entry, size_t bytes) { f(id, entry.info, bytes); });
+}
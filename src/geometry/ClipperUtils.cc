@@ -2,12 +2,15 @@
 #include "geometry/linalg.h"
 #include "geometry/Polygon2d.h"
 #include "clipper2/clipper.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 #include <algorithm>
 #include <clipper2/clipper.engine.h>
 #include <cmath>
 #include <cassert>
+#include <cstdint>
+#include <iterator>
 #include <utility>
 #include <memory>
 #include <cstddef>
@@ -59,18 +62,25 @@ void minkowski_outline(const Clipper2Lib::Path64& poly, const Clipper2Lib::Path6
       pp.push_back(p);
     }
 
-  quads.reserve((pathCnt + delta) * (polyCnt + 1));
-  for (size_t i = 0; i < pathCnt - 1 + delta; ++i)
-    for (size_t j = 0; j < polyCnt; ++j) {
-      Clipper2Lib::Path64 quad;
-      quad.reserve(4);
-      quad.push_back(pp[i % pathCnt][j % polyCnt]);
-      quad.push_back(pp[(i + 1) % pathCnt][j % polyCnt]);
-      quad.push_back(pp[(i + 1) % pathCnt][(j + 1) % polyCnt]);
-      quad.push_back(pp[i % pathCnt][(j + 1) % polyCnt]);
-      if (!IsPositive(quad)) std::reverse(quad.begin(), quad.end());
-      quads.push_back(quad);
-    }
+  // The quads are independent, so rows of them are computed in parallel
+  const size_t rows = pathCnt - 1 + delta;
+  const size_t first = quads.size();
+  quads.resize(first + rows * polyCnt);
+  const size_t rowsPerChunk = std::max<size_t>(4096 / std::max<size_t>(polyCnt, 1), 1);
+  std::vector<size_t> chunks;
+  for (size_t i = 0; i < rows; i += rowsPerChunk) chunks.push_back(i);
+  parallelizable_for_each(chunks.begin(), chunks.end(), [&](size_t begin) {
+    for (size_t i = begin, end = std::min(begin + rowsPerChunk, rows); i < end; ++i)
+      for (size_t j = 0; j < polyCnt; ++j) {
+        Clipper2Lib::Path64& quad = quads[first + i * polyCnt + j];
+        quad.reserve(4);
+        quad.push_back(pp[i % pathCnt][j % polyCnt]);
+        quad.push_back(pp[(i + 1) % pathCnt][j % polyCnt]);
+        quad.push_back(pp[(i + 1) % pathCnt][(j + 1) % polyCnt]);
+        quad.push_back(pp[i % pathCnt][(j + 1) % polyCnt]);
+        if (!IsPositive(quad)) std::reverse(quad.begin(), quad.end());
+      }
+  });
 }
 
 // Add the polygon a translated to an arbitrary point of each separate component of b.
@@ -95,6 +105,77 @@ void fill_minkowski_insides(const Clipper2Lib::Paths64& a, const Clipper2Lib::Pa
   }
 }
 
+// Interleaves the bits of x and y
+uint32_t zOrder(uint16_t x, uint16_t y)
+{
+  auto spread = [](uint32_t v) {
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1);
+}
+
+// Number of path sets unioned in one Clipper pass by unionReduce()
+constexpr size_t UNION_BATCH_SIZE = 64;
+
+/*!
+   Replaces the path sets by at most UNION_BATCH_SIZE path sets with the same NonZero union.
+
+   A single Clipper pass over tens of thousands of small shapes spends most of its time
+   sweeping edges of shapes far apart, so instead nearby sets (by the Z-order of their
+   bounding box centers) are unioned in small batches, in parallel, and the results are
+   merged the same way until few enough are left for the final pass.
+ */
+void unionReduce(std::vector<Clipper2Lib::Paths64>& pathsvector)
+{
+  if (pathsvector.size() <= UNION_BATCH_SIZE) return;
+
+  std::vector<Clipper2Lib::Point64> centers(pathsvector.size());
+  parallelizable_transform(pathsvector.begin(), pathsvector.end(), centers.begin(),
+                           [](const Clipper2Lib::Paths64& paths) {
+                             if (paths.empty()) return Clipper2Lib::Point64(0, 0);
+                             return Clipper2Lib::GetBounds(paths).MidPoint();
+                           });
+  auto [min_x, max_x] = std::minmax_element(centers.begin(), centers.end(),
+                                            [](const auto& a, const auto& b) { return a.x < b.x; });
+  auto [min_y, max_y] = std::minmax_element(centers.begin(), centers.end(),
+                                            [](const auto& a, const auto& b) { return a.y < b.y; });
+  const auto to16bits = [](int64_t v, int64_t min, int64_t max) {
+    return static_cast<uint16_t>(max > min ? 65535.0 * (static_cast<double>(v) - min) / (max - min) : 0);
+  };
+  std::vector<std::pair<uint32_t, size_t>> order(pathsvector.size());
+  for (size_t i = 0; i < pathsvector.size(); ++i) {
+    order[i] = {zOrder(to16bits(centers[i].x, min_x->x, max_x->x),
+                       to16bits(centers[i].y, min_y->y, max_y->y)),
+                i};
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<Clipper2Lib::Paths64> sorted;
+  sorted.reserve(pathsvector.size());
+  for (const auto& [key, i] : order) sorted.push_back(std::move(pathsvector[i]));
+  pathsvector = std::move(sorted);
+
+  while (pathsvector.size() > UNION_BATCH_SIZE) {
+    std::vector<size_t> batches;
+    for (size_t i = 0; i < pathsvector.size(); i += UNION_BATCH_SIZE) batches.push_back(i);
+    std::vector<Clipper2Lib::Paths64> merged(batches.size());
+    parallelizable_transform(batches.begin(), batches.end(), merged.begin(), [&](size_t begin) {
+      Clipper2Lib::Clipper64 clipper;
+      clipper.PreserveCollinear(false);
+      const size_t end = std::min(begin + UNION_BATCH_SIZE, pathsvector.size());
+      for (size_t i = begin; i < end; ++i) clipper.AddSubject(pathsvector[i]);
+      Clipper2Lib::Paths64 result;
+      clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, result);
+      return result;
+    });
+    pathsvector = std::move(merged);
+  }
+}
+
 void SimplifyPolyTree(const Clipper2Lib::PolyPath64& polytree, double epsilon,
                       Clipper2Lib::PolyPath64& result)
 {
@@ -130,8 +211,10 @@ Clipper2Lib::Paths64 fromPolygon2d(const Polygon2d& poly, int scale_bits)
   const bool keep_orientation = poly.isSanitized();
   const double scale = std::ldexp(1.0, scale_bits);
   Clipper2Lib::Paths64 result;
+  result.reserve(poly.outlines().size());
   for (const auto& outline : poly.outlines()) {
     Clipper2Lib::Path64 p;
+    p.reserve(outline.vertices.size());
     for (const auto& v : outline.vertices) {
       p.emplace_back(v[0] * scale, v[1] * scale);
     }
@@ -196,10 +279,11 @@ std::unique_ptr<Polygon2d> toPolygon2d(const Clipper2Lib::PolyTree64& polytree,
 
     // SimplifyPath can potentially reduce the polygon down to no vertices
     if (cleaned_path.size() >= 3) {
+      outline.vertices.reserve(cleaned_path.size());
       for (const auto& ip : cleaned_path) {
         outline.vertices.emplace_back(scale * ip.x, scale * ip.y);
       }
-      result->addOutline(outline);
+      result->addOutline(std::move(outline));
     }
     for (const auto& child : node) {
       processChildren(processChildren, *child);
@@ -217,7 +301,7 @@ std::unique_ptr<Polygon2d> toPolygon2d(const Clipper2Lib::PolyTree64& polytree,
 
    May return an empty Polygon2d, but will not return nullptr.
  */
-std::unique_ptr<Polygon2d> apply(const std::vector<Clipper2Lib::Paths64>& pathsvector,
+std::unique_ptr<Polygon2d> apply(std::vector<Clipper2Lib::Paths64> pathsvector,
                                  Clipper2Lib::ClipType clipType, int scale_bits)
 {
   Clipper2Lib::Clipper64 clipper;
@@ -239,6 +323,10 @@ std::unique_ptr<Polygon2d> apply(const std::vector<Clipper2Lib::Paths64>& pathsv
     return ClipperUtils::toPolygon2d(result, scale_bits);
   }
 
+  if (clipType == Clipper2Lib::ClipType::Union) {
+    unionReduce(pathsvector);
+  }
+
   bool first = true;
   for (const auto& paths : pathsvector) {
     if (first) {
@@ -266,20 +354,35 @@ std::unique_ptr<Polygon2d> apply(const std::vector<std::shared_ptr<const Polygon
 {
   const int scale_bits = scaleBitsFromPrecision();
 
+  // Polygons are converted in parallel. Sanitizing may print warnings, which are
+  // collected per polygon and output in order afterwards.
+  struct Converted {
+    Clipper2Lib::Paths64 paths;
+    std::vector<std::pair<Message, bool>> messages;
+  };
+  std::vector<Converted> converted(polygons.size());
+  parallelizable_transform(polygons.begin(), polygons.end(), converted.begin(),
+                           [scale_bits](const std::shared_ptr<const Polygon2d>& polygon) {
+                             // Empty objects are kept, as they could be the positive object in a
+                             // difference
+                             Converted result;
+                             if (!polygon) return result;
+                             MessageCapture capture;
+                             result.paths = fromPolygon2d(*polygon, scale_bits);
+                             if (!polygon->isSanitized()) {
+                               result.paths = Clipper2Lib::PolyTreeToPaths64(*sanitize(result.paths));
+                             }
+                             result.messages = capture.release();
+                             return result;
+                           });
+
   std::vector<Clipper2Lib::Paths64> pathsvector;
-  for (const auto& polygon : polygons) {
-    if (polygon) {
-      auto polypaths = fromPolygon2d(*polygon, scale_bits);
-      if (!polygon->isSanitized()) {
-        polypaths = Clipper2Lib::PolyTreeToPaths64(*sanitize(polypaths));
-      }
-      pathsvector.push_back(std::move(polypaths));
-    } else {
-      // Insert empty object as this could be the positive object in a difference
-      pathsvector.emplace_back();
-    }
+  pathsvector.reserve(converted.size());
+  for (auto& c : converted) {
+    MessageCapture::replay(c.messages);
+    pathsvector.push_back(std::move(c.paths));
   }
-  auto res = apply(pathsvector, clipType, scale_bits);
+  auto res = apply(std::move(pathsvector), clipType, scale_bits);
   assert(res);
   return res;
 }
@@ -305,12 +408,15 @@ std::unique_ptr<Polygon2d> applyMinkowski(const std::vector<std::shared_ptr<cons
     auto rhs = fromPolygon2d(*polygons[i], scale_bits);
 
     // First, convolve each outline of lhs with the outlines of rhs
-    for (auto const& rhs_path : rhs) {
-      for (auto const& lhs_path : lhs) {
-        Clipper2Lib::Paths64 result;
-        minkowski_outline(lhs_path, rhs_path, result, true, true);
-        minkowski_terms.insert(minkowski_terms.end(), result.begin(), result.end());
-      }
+    std::vector<Clipper2Lib::Paths64> outlines(rhs.size() * lhs.size());
+    parallelizable_cross_product_transform(rhs, lhs, outlines.begin(),
+                                           [](const auto& rhs_path, const auto& lhs_path) {
+                                             Clipper2Lib::Paths64 result;
+                                             minkowski_outline(lhs_path, rhs_path, result, true, true);
+                                             return result;
+                                           });
+    for (auto& result : outlines) {
+      std::move(result.begin(), result.end(), std::back_inserter(minkowski_terms));
     }
 
     // Then, fill the central parts
@@ -352,15 +458,21 @@ std::unique_ptr<Polygon2d> applyProjection(const std::vector<std::shared_ptr<con
 {
   const int scale_bits = scaleBitsFromPrecision();
 
-  Clipper2Lib::Clipper64 sumclipper;
-  sumclipper.PreserveCollinear(false);
-  for (const auto& poly : polygons) {
+  std::vector<Clipper2Lib::Paths64> pathsvector(polygons.size());
+  const auto toPaths = [scale_bits](const std::shared_ptr<const Polygon2d>& poly) {
     Clipper2Lib::Paths64 result = ClipperUtils::fromPolygon2d(*poly, scale_bits);
     // Using NonZero ensures that we don't create holes from polygons sharing
     // edges since we're unioning a mesh
-    result = ClipperUtils::process(result, Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero);
+    return ClipperUtils::process(result, Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero);
+  };
+  parallelizable_transform(polygons.begin(), polygons.end(), pathsvector.begin(), toPaths);
+  unionReduce(pathsvector);
+
+  Clipper2Lib::Clipper64 sumclipper;
+  sumclipper.PreserveCollinear(false);
+  for (const auto& paths : pathsvector) {
     // Add correctly winded polygons to the main clipper
-    sumclipper.AddSubject(result);
+    sumclipper.AddSubject(paths);
   }
 
   Clipper2Lib::PolyTree64 sumresult;
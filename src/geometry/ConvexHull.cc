@@ -0,0 +1,515 @@
+#include "geometry/ConvexHull.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+#include "utils/parallel.h"
+
+namespace ConvexHull {
+
+namespace {
+
+// Point clouds are processed in parallel in chunks of this many points
+constexpr size_t chunkSize = 16384;
+
+std::vector<size_t> chunkStarts(size_t n)
+{
+  std::vector<size_t> chunks;
+  for (size_t begin = 0; begin < n; begin += chunkSize) chunks.push_back(begin);
+  return chunks;
+}
+
+// Twice the signed area of the triangle o, a, b: positive if counter-clockwise
+double cross(const Vector2d& o, const Vector2d& a, const Vector2d& b)
+{
+  return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+}
+
+bool lexicographicLess(const Vector2d& a, const Vector2d& b)
+{
+  return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+}
+
+// Returns the indices of the points maximizing the dot product with each of the directions
+template <typename Points, typename Vector, size_t N>
+std::array<size_t, N> extremePoints(const Points& points, const std::array<Vector, N>& directions)
+{
+  const auto further = [&](size_t i, size_t j, size_t d) {
+    return points[i].dot(directions[d]) > points[j].dot(directions[d]);
+  };
+  const auto chunks = chunkStarts(points.size());
+  std::vector<std::array<size_t, N>> chunkExtremes(chunks.size());
+  parallelizable_transform(chunks.begin(), chunks.end(), chunkExtremes.begin(), [&](size_t begin) {
+    std::array<size_t, N> extremes;
+    extremes.fill(begin);
+    for (size_t i = begin, end = std::min(begin + chunkSize, points.size()); i < end; ++i) {
+      for (size_t d = 0; d < N; ++d) {
+        if (further(i, extremes[d], d)) extremes[d] = i;
+      }
+    }
+    return extremes;
+  });
+  std::array<size_t, N> extremes = chunkExtremes.front();
+  for (const auto& chunk : chunkExtremes) {
+    for (size_t d = 0; d < N; ++d) {
+      if (further(chunk[d], extremes[d], d)) extremes[d] = chunk[d];
+    }
+  }
+  return extremes;
+}
+
+// Keeps the points for which keep(point) is true, in parallel
+template <typename Points, typename Predicate>
+void filterPoints(Points& points, const Predicate& keep)
+{
+  std::vector<char> keepPoint(points.size());
+  parallelizable_transform(points.begin(), points.end(), keepPoint.begin(),
+                           [&](const auto& p) -> char { return keep(p); });
+  size_t n = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (keepPoint[i]) points[n++] = points[i];
+  }
+  points.resize(n);
+}
+
+/*!
+   Removes points strictly inside the polygon spanned by the extreme points in eight
+   directions. These can't be hull vertices, and for clouds sampled from round shapes
+   this removes most of the points not on the hull before sorting.
+ */
+void discardInteriorPoints(VectorOfVector2d& points)
+{
+  // In counter-clockwise order
+  static const std::array<Vector2d, 8> directions = {
+    Vector2d(-1, 0), Vector2d(-1, -1), Vector2d(0, -1), Vector2d(1, -1),
+    Vector2d(1, 0),  Vector2d(1, 1),   Vector2d(0, 1),  Vector2d(-1, 1),
+  };
+  VectorOfVector2d polygon;
+  for (const size_t i : extremePoints(points, directions)) {
+    if (polygon.empty() || points[i] != polygon.back()) polygon.push_back(points[i]);
+  }
+  while (polygon.size() > 1 && polygon.front() == polygon.back()) polygon.pop_back();
+  if (polygon.size() < 3) return;
+
+  filterPoints(points, [&](const Vector2d& p) {
+    for (size_t i = 0; i < polygon.size(); ++i) {
+      if (cross(polygon[i], polygon[(i + 1) % polygon.size()], p) <= 0) return true;
+    }
+    return false;
+  });
+}
+
+/*!
+   Incremental 3D quickhull over a fixed point array.
+
+   Faces are triangles with outward counter-clockwise vertices. Each face holds the
+   points above it, and the loop repeatedly adds the point furthest above a face,
+   replacing the faces it sees by a fan from the horizon to the point.
+ */
+class QuickHull
+{
+public:
+  QuickHull(const std::vector<Vector3d>& points) : points(points)
+  {
+    double extent = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+      double max = 0;
+      for (const auto& p : points) max = std::max(max, std::fabs(p[axis]));
+      extent += max;
+    }
+    // As in John Lloyd's QuickHull3D, this bounds the rounding error of the plane distances
+    this->tolerance = 3 * std::numeric_limits<double>::epsilon() * extent;
+  }
+
+  // Creates the initial tetrahedron, given the indices of the points with minimum and maximum
+  // x, y and z (in this order). Returns false if the points are coplanar, in which case
+  // plane is set to three points spanning their plane, or collinear.
+  bool createSimplex(const std::array<size_t, 6>& extremes, std::array<int, 3>& plane);
+  // Adds the given points to the hull
+  void addPoints(const std::vector<int>& candidates);
+  std::unique_ptr<PolySet> toPolySet() const;
+
+private:
+  struct Face {
+    std::array<int, 3> vertices;
+    // neighbors[i] is the face across the edge vertices[i] -> vertices[(i + 1) % 3]
+    std::array<int, 3> neighbors;
+    Vector3d normal;
+    double offset;
+    std::vector<int> outside;
+    int furthest = -1;
+    double furthestDistance = 0;
+    bool deleted = false;
+    int visible = -1;  // iteration the face was last found visible in
+
+    [[nodiscard]] double distance(const Vector3d& p) const { return normal.dot(p) - offset; }
+  };
+  struct HorizonEdge {
+    int face;
+    int edge;
+  };
+
+  int addFace(int a, int b, int c);
+  int edgeIndex(const Face& face, int from) const;
+  void assign(const std::vector<int>& candidates, const std::vector<int>& faceIndices);
+  bool findHorizon(int eye, int start, std::vector<int>& visible, std::vector<HorizonEdge>& horizon);
+  void expand();
+
+  const std::vector<Vector3d>& points;
+  double tolerance;
+  std::vector<Face> faces;
+  std::vector<int> pending;  // faces which may have points outside
+  int iteration = 0;
+};
+
+int QuickHull::addFace(int a, int b, int c)
+{
+  Face face;
+  face.vertices = {a, b, c};
+  face.neighbors = {-1, -1, -1};
+  const Vector3d normal = (points[b] - points[a]).cross(points[c] - points[a]);
+  const double norm = normal.norm();
+  // A sliver face gets a zero normal, so no point is ever considered above it
+  face.normal = norm > 0 ? Vector3d(normal / norm) : Vector3d::Zero();
+  face.offset = face.normal.dot(points[a]);
+  faces.push_back(std::move(face));
+  return static_cast<int>(faces.size() - 1);
+}
+
+// Returns the index of the edge of face starting at vertex from
+int QuickHull::edgeIndex(const Face& face, int from) const
+{
+  for (int i = 0; i < 3; ++i) {
+    if (face.vertices[i] == from) return i;
+  }
+  return -1;
+}
+
+bool QuickHull::createSimplex(const std::array<size_t, 6>& extremes, std::array<int, 3>& plane)
+{
+  // Start from the two most distant of the extreme points along the axes
+  int v0 = 0;
+  int v1 = 0;
+  double maxDistance = -1;
+  for (int axis = 0; axis < 3; ++axis) {
+    const double d = (points[extremes[2 * axis + 1]] - points[extremes[2 * axis]]).squaredNorm();
+    if (d > maxDistance) {
+      maxDistance = d;
+      v0 = static_cast<int>(extremes[2 * axis]);
+      v1 = static_cast<int>(extremes[2 * axis + 1]);
+    }
+  }
+
+  // Then the point furthest from their line, and the point furthest from the plane of all three
+  const Vector3d direction = (points[v1] - points[v0]).normalized();
+  int v2 = v0;
+  maxDistance = 0;
+  for (int i = 0; i < static_cast<int>(points.size()); ++i) {
+    const double d = (points[i] - points[v0]).cross(direction).norm();
+    if (d > maxDistance) {
+      maxDistance = d;
+      v2 = i;
+    }
+  }
+  if (maxDistance <= tolerance) return false;  // collinear
+  plane = {v0, v1, v2};
+
+  const Vector3d normal = (points[v1] - points[v0]).cross(points[v2] - points[v0]).normalized();
+  int v3 = v0;
+  maxDistance = 0;
+  for (int i = 0; i < static_cast<int>(points.size()); ++i) {
+    const double d = std::fabs(normal.dot(points[i] - points[v0]));
+    if (d > maxDistance) {
+      maxDistance = d;
+      v3 = i;
+    }
+  }
+  if (maxDistance <= tolerance) return false;  // coplanar
+
+  // Orient the base away from the apex
+  if (normal.dot(points[v3] - points[v0]) > 0) std::swap(v1, v2);
+  addFace(v0, v1, v2);
+  addFace(v0, v3, v1);
+  addFace(v1, v3, v2);
+  addFace(v2, v3, v0);
+  for (auto& face : faces) {
+    for (int i = 0; i < 3; ++i) {
+      const int from = face.vertices[(i + 1) % 3];
+      for (int j = 0; j < 4; ++j) {
+        const int k = edgeIndex(faces[j], from);
+        if (&faces[j] != &face && k >= 0 && faces[j].vertices[(k + 1) % 3] == face.vertices[i]) {
+          face.neighbors[i] = j;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Gives each candidate point to the face it is furthest above, discarding points inside
+void QuickHull::assign(const std::vector<int>& candidates, const std::vector<int>& faceIndices)
+{
+  const auto findFace = [&](int point) {
+    int best = -1;
+    double bestDistance = tolerance;
+    for (const int f : faceIndices) {
+      const double d = faces[f].distance(points[point]);
+      if (d > bestDistance) {
+        bestDistance = d;
+        best = f;
+      }
+    }
+    return best;
+  };
+  std::vector<int> assignment(candidates.size());
+  if (candidates.size() > chunkSize) {
+    parallelizable_transform(candidates.begin(), candidates.end(), assignment.begin(), findFace);
+  } else {
+    std::transform(candidates.begin(), candidates.end(), assignment.begin(), findFace);
+  }
+
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (assignment[i] < 0) continue;
+    auto& face = faces[assignment[i]];
+    const double d = face.distance(points[candidates[i]]);
+    if (face.outside.empty()) pending.push_back(assignment[i]);
+    face.outside.push_back(candidates[i]);
+    if (d > face.furthestDistance) {
+      face.furthestDistance = d;
+      face.furthest = candidates[i];
+    }
+  }
+}
+
+void QuickHull::addPoints(const std::vector<int>& candidates)
+{
+  std::vector<int> liveFaces;
+  for (int f = 0; f < static_cast<int>(faces.size()); ++f) {
+    if (!faces[f].deleted) liveFaces.push_back(f);
+  }
+  assign(candidates, liveFaces);
+  expand();
+}
+
+/*!
+   Finds the faces visible from eye, starting at the visible face start, by a depth-first
+   search which yields the horizon edges in counter-clockwise order. Returns false if the
+   horizon isn't a single loop, which only happens due to rounding.
+ */
+bool QuickHull::findHorizon(int eye, int start, std::vector<int>& visible,
+                            std::vector<HorizonEdge>& horizon)
+{
+  struct Frame {
+    int face;
+    int firstEdge;
+    int next;
+  };
+  std::vector<Frame> stack;
+  faces[start].visible = iteration;
+  visible.push_back(start);
+  stack.push_back({start, 0, 0});
+  while (!stack.empty()) {
+    const Frame frame = stack.back();
+    if (frame.next == 3) {
+      stack.pop_back();
+      continue;
+    }
+    stack.back().next++;
+    const int edge = (frame.firstEdge + frame.next) % 3;
+    const int neighbor = faces[frame.face].neighbors[edge];
+    if (faces[neighbor].visible == iteration) continue;
+    if (faces[neighbor].distance(points[eye]) > tolerance) {
+      faces[neighbor].visible = iteration;
+      visible.push_back(neighbor);
+      // Continue after the edge shared with this face, which starts at this edge's end
+      const int shared = edgeIndex(faces[neighbor], faces[frame.face].vertices[(edge + 1) % 3]);
+      stack.push_back({neighbor, (shared + 1) % 3, 0});
+    } else {
+      horizon.push_back({frame.face, edge});
+    }
+  }
+
+  for (size_t i = 0; i < horizon.size(); ++i) {
+    const auto& edge = horizon[i];
+    const auto& next = horizon[(i + 1) % horizon.size()];
+    if (faces[edge.face].vertices[(edge.edge + 1) % 3] != faces[next.face].vertices[next.edge]) {
+      return false;
+    }
+  }
+  return horizon.size() >= 3;
+}
+
+void QuickHull::expand()
+{
+  std::vector<int> visible;
+  std::vector<HorizonEdge> horizon;
+  std::vector<int> newFaces;
+  std::vector<int> orphans;
+  while (!pending.empty()) {
+    const int start = pending.back();
+    if (faces[start].deleted || faces[start].outside.empty()) {
+      pending.pop_back();
+      continue;
+    }
+    const int eye = faces[start].furthest;
+
+    ++iteration;
+    visible.clear();
+    horizon.clear();
+    if (!findHorizon(eye, start, visible, horizon)) {
+      // Treat the point as lying on the hull
+      auto& face = faces[start];
+      face.outside.erase(std::find(face.outside.begin(), face.outside.end(), eye));
+      face.furthest = -1;
+      face.furthestDistance = 0;
+      for (const int p : face.outside) {
+        const double d = face.distance(points[p]);
+        if (d > face.furthestDistance) {
+          face.furthestDistance = d;
+          face.furthest = p;
+        }
+      }
+      continue;
+    }
+
+    // Replace the visible faces by a fan from the horizon to the eye point
+    newFaces.clear();
+    for (const auto& [face, edge] : horizon) {
+      const int a = faces[face].vertices[edge];
+      const int b = faces[face].vertices[(edge + 1) % 3];
+      const int opposite = faces[face].neighbors[edge];
+      const int f = addFace(a, b, eye);
+      faces[f].neighbors[0] = opposite;
+      faces[opposite].neighbors[edgeIndex(faces[opposite], b)] = f;
+      newFaces.push_back(f);
+    }
+    for (size_t i = 0; i < newFaces.size(); ++i) {
+      faces[newFaces[i]].neighbors[1] = newFaces[(i + 1) % newFaces.size()];
+      faces[newFaces[i]].neighbors[2] = newFaces[(i + newFaces.size() - 1) % newFaces.size()];
+    }
+
+    orphans.clear();
+    for (const int f : visible) {
+      auto& face = faces[f];
+      face.deleted = true;
+      for (const int p : face.outside) {
+        if (p != eye) orphans.push_back(p);
+      }
+      face.outside = std::vector<int>();
+    }
+    assign(orphans, newFaces);
+  }
+}
+
+std::unique_ptr<PolySet> QuickHull::toPolySet() const
+{
+  auto ps = std::make_unique<PolySet>(3, true);
+  ps->setTriangular(true);
+  ps->setManifold(true);
+  auto& vertices = ps->vertices.mut();
+  auto& indices = ps->indices.mut();
+  std::vector<int> vertexIndex(points.size(), -1);
+  for (const auto& face : faces) {
+    if (face.deleted) continue;
+    auto& polygon = indices.emplace_back();
+    for (const int v : face.vertices) {
+      if (vertexIndex[v] < 0) {
+        vertexIndex[v] = static_cast<int>(vertices.size());
+        vertices.push_back(points[v]);
+      }
+      polygon.push_back(vertexIndex[v]);
+    }
+  }
+  return ps;
+}
+
+// Returns the hull of coplanar points as a single polygon
+std::unique_ptr<PolySet> planarHull(const std::vector<Vector3d>& points, const std::array<int, 3>& plane)
+{
+  const Vector3d origin = points[plane[0]];
+  const Vector3d u = (points[plane[1]] - origin).normalized();
+  const Vector3d normal = u.cross(points[plane[2]] - origin).normalized();
+  const Vector3d v = normal.cross(u);
+
+  VectorOfVector2d projected(points.size());
+  parallelizable_transform(points.begin(), points.end(), projected.begin(), [&](const Vector3d& p) {
+    return Vector2d((p - origin).dot(u), (p - origin).dot(v));
+  });
+  const auto outline = hull2d(std::move(projected));
+  if (outline.size() < 3) return nullptr;
+
+  auto ps = std::make_unique<PolySet>(3, true);
+  auto& polygon = ps->indices.mut().emplace_back();
+  for (const auto& p : outline) {
+    polygon.push_back(static_cast<int>(ps->vertices.size()));
+    ps->vertices.mut().push_back(origin + p[0] * u + p[1] * v);
+  }
+  return ps;
+}
+
+}  // namespace
+
+VectorOfVector2d hull2d(VectorOfVector2d points)
+{
+  if (points.size() > chunkSize) discardInteriorPoints(points);
+
+  // Andrew's monotone chain
+  std::sort(points.begin(), points.end(), lexicographicLess);
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+  if (points.size() < 3) return points;
+
+  VectorOfVector2d hull(2 * points.size());
+  size_t k = 0;
+  for (const auto& p : points) {
+    while (k >= 2 && cross(hull[k - 2], hull[k - 1], p) <= 0) --k;
+    hull[k++] = p;
+  }
+  for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;) {
+    while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) --k;
+    hull[k++] = points[i];
+  }
+  hull.resize(k - 1);
+  return hull;
+}
+
+std::unique_ptr<PolySet> hull3d(const std::vector<Vector3d>& points)
+{
+  if (points.size() < 4) return nullptr;
+
+  // The extreme points in the axis and diagonal directions
+  static const std::array<Vector3d, 14> directions = {
+    Vector3d(-1, 0, 0),  Vector3d(1, 0, 0),   Vector3d(0, -1, 0),  Vector3d(0, 1, 0),
+    Vector3d(0, 0, -1),  Vector3d(0, 0, 1),   Vector3d(1, 1, 1),   Vector3d(1, 1, -1),
+    Vector3d(1, -1, 1),  Vector3d(1, -1, -1), Vector3d(-1, 1, 1),  Vector3d(-1, 1, -1),
+    Vector3d(-1, -1, 1), Vector3d(-1, -1, -1),
+  };
+  const auto extremes = extremePoints(points, directions);
+
+  QuickHull quickhull(points);
+  std::array<int, 3> plane{};
+  std::array<size_t, 6> axisExtremes;
+  std::copy(extremes.begin(), extremes.begin() + 6, axisExtremes.begin());
+  if (!quickhull.createSimplex(axisExtremes, plane)) {
+    return plane[0] == plane[1] ? nullptr : planarHull(points, plane);
+  }
+
+  // First build the hull of the extreme points. Its vertices are hull vertices, so the
+  // points inside it are discarded without ever being assigned to a face.
+  quickhull.addPoints(std::vector<int>(extremes.begin(), extremes.end()));
+
+  std::vector<int> candidates(points.size());
+  for (size_t i = 0; i < points.size(); ++i) candidates[i] = static_cast<int>(i);
+  quickhull.addPoints(candidates);
+
+  return quickhull.toPolySet();
+}
+
+}  // namespace ConvexHull
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+
+/*!
+   Convex hulls of point clouds in double precision, independent of CGAL.
+
+   In 3D, points closer to a hull face than a tolerance relative to the extent of
+   the input are treated as lying on it, so nearly coplanar points can't produce
+   inconsistent decisions, and the result is always a closed convex mesh.
+ */
+namespace ConvexHull {
+
+// Returns the hull vertices in counter-clockwise order, starting with the lexicographically smallest
+// point and without collinear points. Fewer than three points are returned as is, minus duplicates.
+VectorOfVector2d hull2d(VectorOfVector2d points);
+
+// Returns the hull as a triangulated, convex PolySet, a single polygon if all points are coplanar,
+// or nullptr if the points are collinear or fewer than four.
+std::unique_ptr<PolySet> hull3d(const std::vector<Vector3d>& points);
+
+}  // namespace ConvexHull
@@ -1,13 +1,74 @@
 #include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/linalg.h"
+#include "utils/MemoryStatistic.h"
 #include "utils/printutils.h"
 #include <sstream>
 #include <memory>
 #include <boost/foreach.hpp>
+#include <boost/optional.hpp>
 #include <cstddef>
 #include <string>
 #include <utility>
 
+namespace {
+
+struct MemoryCategoryVisitor : public GeometryVisitor {
+  // Lists only refer to their children, which are tracked themselves
+  void visit(const GeometryList& /*node*/) override {}
+  void visit(const PolySet& /*node*/) override { category = MemoryStatistic::Category::PolySets; }
+  void visit(const Polygon2d& /*node*/) override {}
+#ifdef ENABLE_CGAL
+  void visit(const CGALNefGeometry& /*node*/) override
+  {
+    category = MemoryStatistic::Category::NefPolyhedra;
+  }
+#endif
+#ifdef ENABLE_MANIFOLD
+  void visit(const ManifoldGeometry& /*node*/) override
+  {
+    category = MemoryStatistic::Category::ManifoldMeshes;
+  }
+#endif
+  boost::optional<MemoryStatistic::Category> category;
+};
+
+struct TypeNameVisitor : public GeometryVisitor {
+  void visit(const GeometryList& /*node*/) override { name = "list"; }
+  void visit(const PolySet& /*node*/) override { name = "polyset"; }
+  void visit(const Polygon2d& /*node*/) override { name = "polygon2d"; }
+#ifdef ENABLE_CGAL
+  void visit(const CGALNefGeometry& /*node*/) override { name = "nef_polyhedron"; }
+#endif
+#ifdef ENABLE_MANIFOLD
+  void visit(const ManifoldGeometry& /*node*/) override { name = "manifold"; }
+#endif
+  const char *name = "unknown";
+};
+
+}  // namespace
+
+void Geometry::trackMemory(size_t bytes) const
+{
+  MemoryCategoryVisitor visitor;
+  // Visiting an instance would compute its transformed mesh
+  if (dynamic_cast<const InstancedGeometry *>(this)) {
+    visitor.category = MemoryStatistic::Category::PolySets;
+  } else {
+    this->accept(visitor);
+  }
+  if (visitor.category) this->tracked_memory.update(*visitor.category, bytes);
+}
+
+const char *Geometry::typeName() const
+{
+  // Visiting an instance would compute its transformed mesh
+  if (dynamic_cast<const InstancedGeometry *>(this)) return "instance";
+  TypeNameVisitor visitor;
+  this->accept(visitor);
+  return visitor.name;
+}
+
 GeometryList::GeometryList(Geometry::Geometries geometries) : children(std::move(geometries))
 {
 }
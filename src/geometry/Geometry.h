@@ -8,6 +8,7 @@
 #include <memory>
 
 #include "geometry/linalg.h"
+#include "utils/MemoryStatistic.h"
 
 class AbstractNode;
 class CGALNefGeometry;
@@ -51,8 +52,17 @@ public:
 
   virtual void accept(GeometryVisitor& visitor) const = 0;
 
+  // Accounts bytes, the memsize() of this geometry, in MemoryStatistic while it is alive
+  void trackMemory(size_t bytes) const;
+  [[nodiscard]] bool isMemoryTracked() const { return tracked_memory.size() > 0; }
+  // Short name of the kind of geometry, e.g. "polyset" or "manifold"
+  [[nodiscard]] const char *typeName() const;
+
 protected:
   int convexity{1};
+
+private:
+  mutable MemoryStatistic::Tracked tracked_memory;
 };
 
 /**
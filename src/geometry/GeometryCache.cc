@@ -5,6 +5,7 @@
 #include <memory>
 #include <cstddef>
 #include <string>
+#include <utility>
 
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGALNefGeometry.h"
@@ -14,20 +15,27 @@ GeometryCache *GeometryCache::inst = nullptr;
 
 std::shared_ptr<const Geometry> GeometryCache::get(const std::string& id) const
 {
-  const auto& geom = this->cache[id]->geom;
+  const auto *entry = this->cache[id];
+  ++entry->info.hits;
+  this->counters.hit(entry->info.nodeType);
+  const auto& geom = entry->geom;
 #ifdef DEBUG
   PRINTDB("Geometry Cache hit: %s (%d bytes)", id.substr(0, 40) % (geom ? geom->memsize() : 0));
 #endif
   return geom;
 }
 
-bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom)
+bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom,
+                           const CacheEntryInfo& info)
 {
-  auto inserted = this->cache.insert(id, new cache_entry(geom), geom ? geom->memsize() : 0);
+  this->counters.miss(info.nodeType);
+  const size_t bytes = geom ? geom->memsize() : 0;
+  auto inserted = this->cache.insert(id, new cache_entry(geom, info), bytes);
+  ++(inserted ? this->counters.inserts : this->counters.rejected);
 #if defined(ENABLE_CGAL) && defined(DEBUG)
   assert(!dynamic_cast<const CGALNefGeometry *>(geom.get()));
   LOG("Geometry Cache %1$s: %2$s (%3$d bytes)", inserted ? "inserted" : "insert failed",
-      id.substr(0, 40), geom ? geom->memsize() : 0);
+      id.substr(0, 40), bytes);
 #endif
   return inserted;
 }
@@ -52,13 +60,25 @@ void GeometryCache::setMaxSizeMB(size_t limit)
   this->cache.setMaxCost(limit * 1024ul * 1024ul);
 }
 
-void GeometryCache::print()
+void GeometryCache::print(bool details)
 {
   LOG("Geometries in cache: %1$d", this->cache.size());
   LOG("Geometry cache size in bytes: %1$d", this->cache.totalCost());
+  statistic().print("Geometry cache", details);
 }
 
-GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& geom) : geom(geom)
+CacheStatistic GeometryCache::statistic() const
+{
+  return cacheStatistic(this->cache, this->counters);
+}
+
+void GeometryCache::forEachEntry(const CacheEntryFunc& f) const
+{
+  forEachCacheEntry(this->cache, f);
+}
+
+GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& geom, CacheEntryInfo info)
+  : geom(geom), info(std::move(info))
 {
   if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
 }
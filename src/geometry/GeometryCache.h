@@ -5,6 +5,7 @@
 #include <string>
 
 #include "Cache.h"
+#include "geometry/CacheStatistic.h"
 #include "geometry/Geometry.h"
 
 class GeometryCache
@@ -20,13 +21,19 @@ public:
 
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const class Geometry> get(const std::string& id) const;
-  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& geom);
+  // Inserts the computed geometry, counting a miss
+  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& geom,
+              const CacheEntryInfo& info = {});
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
   void setMaxSizeMB(size_t limit);
   void clear() { cache.clear(); }
-  void print();
+  // Logs the size, and the statistic, with its details if details is set
+  void print(bool details = false);
+  [[nodiscard]] CacheStatistic statistic() const;
+  // Calls f for each entry, from the most to the least recently used
+  void forEachEntry(const CacheEntryFunc& f) const;
 
 private:
   static GeometryCache *inst;
@@ -34,8 +41,10 @@ private:
   struct cache_entry {
     std::shared_ptr<const class Geometry> geom;
     std::string msg;
-    cache_entry(const std::shared_ptr<const Geometry>& geom);
+    mutable CacheEntryInfo info;
+    cache_entry(const std::shared_ptr<const Geometry>& geom, CacheEntryInfo info);
   };
 
   Cache<std::string, cache_entry> cache;
+  mutable CacheStatistic counters;
 };
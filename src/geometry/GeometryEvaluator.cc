@@ -1,13 +1,17 @@
 #include "geometry/GeometryEvaluator.h"
 
 #include "Feature.h"
+#include "RenderBudget.h"
+#include "RenderProfiler.h"
 #include "geometry/boolean_utils.h"
 #include "geometry/cgal/cgal.h"
 #include "geometry/ClipperUtils.h"
+#include "geometry/ConvexHull.h"
 #include "geometry/linalg.h"
 #include "geometry/linear_extrude.h"
 #include "geometry/Geometry.h"
 #include "geometry/GeometryCache.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/PolySetUtils.h"
 #include "geometry/PolySet.h"
@@ -17,13 +21,16 @@
 #include "geometry/rotate_extrude.h"
 
 #include "glview/RenderSettings.h"
+#include "io/ImportCache.h"
 
 #include "core/CgalAdvNode.h"
 #include "core/ColorNode.h"
 #include "core/CsgOpNode.h"
+#include "core/ImportNode.h"
 #include "core/ModuleInstantiation.h"
 #include "core/LinearExtrudeNode.h"
 #include "core/OffsetNode.h"
+#include "core/progress.h"
 #include "core/ProjectionNode.h"
 #include "core/RenderNode.h"
 #include "core/RoofNode.h"
@@ -34,19 +41,19 @@
 #include "core/CurveDiscretizer.h"
 #include "core/Tree.h"
 #include "utils/calc.h"
+#include "utils/MemoryStatistic.h"
 #include "utils/degree_trig.h"
 #include "utils/printutils.h"
 
+#include <chrono>
+#include <functional>
 #include <iterator>
 #include <cassert>
-#include <list>
 #include <utility>
 #include <memory>
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGALCache.h"
 #include "geometry/cgal/cgalutils.h"
-#include <CGAL/convex_hull_2.h>
-#include <CGAL/Point_2.h>
 #endif
 #ifdef ENABLE_MANIFOLD
 #include "geometry/manifold/manifoldutils.h"
@@ -58,7 +65,8 @@ class Geometry;
 class Polygon2d;
 class Tree;
 
-GeometryEvaluator::GeometryEvaluator(const Tree& tree) : tree(tree)
+GeometryEvaluator::GeometryEvaluator(const Tree& tree)
+  : lastresult(std::chrono::steady_clock::now()), tree(tree)
 {
 }
 
@@ -70,12 +78,15 @@ GeometryEvaluator::GeometryEvaluator(const Tree& tree) : tree(tree)
    * PolySet geometries are always 3D. 2D Polysets are only created for special-purpose rendering
    operations downstream from here.
    * Needs validation: Implementation-specific geometries shouldn't be mixed (Nef polyhedron, Manifold)
+   * InstancedGeometry is only returned if allowInstances is true; otherwise it's materialized
  */
 std::shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const AbstractNode& node,
-                                                                    bool allownef)
+                                                                    bool allownef, bool allowInstances)
 {
   auto result = smartCacheGet(node, allownef);
   if (!result) {
+    const PrefetchScope prefetch(*this, node);
+    const TimingScope timing(*this);
     // If not found in any caches, we need to evaluate the geometry
     // traverse() will set this->root to a geometry, which can be any geometry
     // (including GeometryList if the lazyunions feature is enabled)
@@ -86,6 +97,10 @@ std::shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const Abstra
     smartCacheInsert(node, result);
   }
 
+  std::shared_ptr<const InstancedGeometry> instance;
+  if (allowInstances) instance = std::dynamic_pointer_cast<const InstancedGeometry>(result);
+  result = instance ? instance->getBase() : InstancedGeometry::materialize(result);
+
   // Convert engine-specific 3D geometry to PolySet if needed
   // Note: we don't store the converted into the cache as it would conflict with subsequent calls where
   // allownef is true.
@@ -102,9 +117,11 @@ std::shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const Abstra
           ps = PolySetUtils::tessellate_faces(*ps);
         }
       }
+      if (instance) return std::make_shared<InstancedGeometry>(ps, instance->getMatrix());
       return ps;
     }
   }
+  if (instance) return instance;
   return result;
 }
 
@@ -145,6 +162,9 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
   Geometry::Geometries children = collectChildren3D(node);
   if (children.empty()) return {};
 
+  if (op == OpenSCADOperator::HULL || op == OpenSCADOperator::MINKOWSKI) {
+    for (auto& item : children) item.second = InstancedGeometry::materialize(item.second);
+  }
   if (op == OpenSCADOperator::HULL) {
     return ResultObject::mutableResult(std::shared_ptr<Geometry>(applyHull(children)));
   } else if (op == OpenSCADOperator::FILL) {
@@ -215,37 +235,22 @@ std::unique_ptr<Polygon2d> GeometryEvaluator::applyHull2D(const AbstractNode& no
   auto children = collectChildren2D(node);
   auto geometry = std::make_unique<Polygon2d>();
 
-#ifdef ENABLE_CGAL
-  using CGALPoint2 = CGAL::Point_2<CGAL_DoubleKernel>;
   // Collect point cloud
-  std::list<CGALPoint2> points;
+  std::vector<Vector2d> points;
   for (const auto& p : children) {
     if (p) {
       for (const auto& o : p->outlines()) {
-        for (const auto& v : o.vertices) {
-          points.emplace_back(v[0], v[1]);
-        }
+        points.insert(points.end(), o.vertices.begin(), o.vertices.end());
       }
     }
   }
   if (points.size() > 0) {
     // Apply hull
-    std::list<CGALPoint2> result;
-    try {
-      CGAL::convex_hull_2(points.begin(), points.end(), std::back_inserter(result));
-      // Construct Polygon2d
-      Outline2d outline;
-      for (const auto& p : result) {
-        outline.vertices.emplace_back(p[0], p[1]);
-      }
-      geometry->addOutline(outline);
-      geometry->setSanitized(true);
-    } catch (const CGAL::Failure_exception& e) {
-      LOG(message_group::Warning, "GeometryEvaluator::applyHull2D() during CGAL::convex_hull_2(): %1$s",
-          e.what());
-    }
+    Outline2d outline;
+    outline.vertices = ConvexHull::hull2d(std::move(points));
+    geometry->addOutline(std::move(outline));
+    geometry->setSanitized(true);
   }
-#endif
   return geometry;
 }
 
@@ -270,6 +275,7 @@ std::unique_ptr<Polygon2d> GeometryEvaluator::applyFill2D(const AbstractNode& no
 std::unique_ptr<Geometry> GeometryEvaluator::applyHull3D(const AbstractNode& node)
 {
   Geometry::Geometries children = collectChildren3D(node);
+  for (auto& item : children) item.second = InstancedGeometry::materialize(item.second);
 
   auto P = PolySet::createEmpty();
   return applyHull(children);
@@ -333,10 +339,18 @@ void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
                                          const std::shared_ptr<const Geometry>& geom)
 {
   const std::string& key = this->tree.getIdString(node);
+  const auto info = [&]() {
+    CacheEntryInfo info;
+    info.nodeType = node.name();
+    info.geometryType = geom ? geom->typeName() : "empty";
+    const auto it = this->computeseconds.find(node.index());
+    if (it != this->computeseconds.end()) info.computeSeconds = it->second;
+    return info;
+  };
 
   if (CGALCache::acceptsGeometry(geom)) {
     if (!CGALCache::instance()->contains(key)) {
-      CGALCache::instance()->insert(key, geom);
+      CGALCache::instance()->insert(key, geom, info());
     }
   } else if (!GeometryCache::instance()->contains(key)) {
     // FIXME: Sanity-check Polygon2d as well?
@@ -345,12 +359,43 @@ void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
     // }
 
     // Perhaps add acceptsGeometry() to GeometryCache as well?
-    if (!GeometryCache::instance()->insert(key, geom)) {
+    if (!GeometryCache::instance()->insert(key, geom, info())) {
       LOG(message_group::Warning, "GeometryEvaluator: Node didn't fit into cache.");
     }
   }
 }
 
+/*!
+   Collects the leaves below node which read files and aren't cached yet, and starts
+   loading them in the background. Leaves are picked up again in the leaf visitors.
+ */
+bool GeometryEvaluator::startPrefetch(const AbstractNode& node)
+{
+  if (this->prefetcher) return false;
+
+  std::vector<const LeafNode *> leaves;
+  std::function<void(const AbstractNode&)> collect = [&](const AbstractNode& n) {
+    if (isSmartCached(n)) return;
+    if (const auto *leaf = dynamic_cast<const LeafNode *>(&n)) {
+      if (!ImportPrefetcher::isPrefetchable(*leaf)) return;
+      if (const auto *import = dynamic_cast<const ImportNode *>(leaf)) {
+        const auto key = ImportCache::instance()->getKey(*import, false);
+        if (!key.empty() && ImportCache::instance()->contains(key)) return;
+      }
+      leaves.push_back(leaf);
+      return;
+    }
+    for (const auto& child : n.getChildren()) collect(*child);
+  };
+  // A single leaf is needed right away, so there is nothing to overlap its loading with
+  if (node.getChildren().empty()) return false;
+  collect(node);
+  if (leaves.empty()) return false;
+
+  this->prefetcher = std::make_unique<ImportPrefetcher>(leaves);
+  return true;
+}
+
 bool GeometryEvaluator::isSmartCached(const AbstractNode& node)
 {
   const std::string& key = this->tree.getIdString(node);
@@ -363,6 +408,7 @@ std::shared_ptr<const Geometry> GeometryEvaluator::smartCacheGet(const AbstractN
   const std::string& key = this->tree.getIdString(node);
   const bool hasgeom = GeometryCache::instance()->contains(key);
   const bool hascgal = CGALCache::instance()->contains(key);
+  if (hascgal || hasgeom) RenderProfiler::cacheHit(node);
   if (hascgal && (preferNef || !hasgeom)) return CGALCache::instance()->get(key);
   if (hasgeom) return GeometryCache::instance()->get(key);
   return {};
@@ -454,6 +500,28 @@ std::unique_ptr<Polygon2d> GeometryEvaluator::applyToChildren2D(const AbstractNo
 void GeometryEvaluator::addToParent(const State& state, const AbstractNode& node,
                                     const std::shared_ptr<const Geometry>& geom)
 {
+  RenderProfiler::result(node, geom.get());
+  progress_result(node, geom.get());
+  // Results from the caches were counted when they were computed
+  if (geom && MemoryStatistic::tracksGeometry() && !geom->isMemoryTracked()) {
+    geom->trackMemory(geom->memsize());
+  }
+
+  // Attributes the time since the previous result to this node. Lists pass on
+  // results which were already timed.
+  const auto now = std::chrono::steady_clock::now();
+  auto [seconds, first] = this->computeseconds.try_emplace(node.index(), 0.0);
+  if (first) {
+    seconds->second = std::chrono::duration<double>(now - this->lastresult).count();
+    if (auto it = this->childseconds.find(node.index()); it != this->childseconds.end()) {
+      seconds->second += it->second;
+      this->childseconds.erase(it);
+    }
+    this->lastresult = now;
+  }
+  if (state.parent()) this->childseconds[state.parent()->index()] += seconds->second;
+
+  RenderBudget::check(&node);
   this->visitedchildren.erase(node.index());
   if (state.parent()) {
     this->visitedchildren[state.parent()->index()].push_back(
@@ -656,7 +724,8 @@ Response GeometryEvaluator::visit(State& state, const LeafNode& node)
   if (state.isPrefix()) {
     std::shared_ptr<const Geometry> geom;
     if (!isSmartCached(node)) {
-      geom = node.createGeometry();
+      if (this->prefetcher) geom = this->prefetcher->take(node);
+      if (!geom) geom = node.createGeometry();
       assert(geom);
       if (const auto polygon = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
         if (!polygon->isSanitized()) {
@@ -674,6 +743,40 @@ Response GeometryEvaluator::visit(State& state, const LeafNode& node)
   return Response::PruneTraversal;
 }
 
+/*!
+   Like other leaf nodes, but imported geometry is also looked up in the
+   ImportCache, which survives changes to the surrounding tree.
+
+   input: None
+   output: PolySet or Polygon2d
+ */
+Response GeometryEvaluator::visit(State& state, const ImportNode& node)
+{
+  if (state.isPrefix()) {
+    std::shared_ptr<const Geometry> geom;
+    if (!isSmartCached(node)) {
+      const auto key = ImportCache::instance()->getKey(node);
+      if (!key.empty()) geom = ImportCache::instance()->get(key);
+      if (!geom) {
+        if (this->prefetcher) geom = this->prefetcher->take(node);
+        if (!geom) geom = node.createGeometry();
+        assert(geom);
+        if (const auto polygon = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
+          if (!polygon->isSanitized()) {
+            geom = ClipperUtils::sanitize(*polygon);
+          }
+        }
+        if (!key.empty()) ImportCache::instance()->insert(key, geom);
+      }
+    } else {
+      geom = smartCacheGet(node, state.preferNef());
+    }
+    addToParent(state, node, geom);
+    node.progress_report();
+  }
+  return Response::PruneTraversal;
+}
+
 Response GeometryEvaluator::visit(State& state, const TextNode& node)
 {
   if (state.isPrefix()) {
@@ -753,9 +856,16 @@ Response GeometryEvaluator::visit(State& state, const TransformNode& node)
               geom = ClipperUtils::sanitize(*polygons);
             }
           } else if (geom->getDimension() == 3) {
-            auto mutableGeom = res.asMutableGeometry();
-            if (mutableGeom) mutableGeom->transform(node.matrix);
-            geom = mutableGeom;
+            // Don't copy a shared mesh just to move it; the transform is applied once needed
+            std::shared_ptr<const Geometry> instance;
+            if (res.isConst()) instance = InstancedGeometry::create(geom, node.matrix);
+            if (instance) {
+              geom = instance;
+            } else {
+              auto mutableGeom = res.asMutableGeometry();
+              if (mutableGeom) mutableGeom->transform(node.matrix);
+              geom = mutableGeom;
+            }
           }
         }
       }
@@ -4,8 +4,10 @@
 #include "geometry/linalg.h"
 #include "core/enums.h"
 #include "geometry/Geometry.h"
+#include "geometry/ImportPrefetcher.h"
 
 #include <cassert>
+#include <chrono>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -23,7 +25,42 @@ class GeometryEvaluator : public NodeVisitor
 public:
   GeometryEvaluator(const Tree& tree);
 
-  std::shared_ptr<const Geometry> evaluateGeometry(const AbstractNode& node, bool allownef);
+  std::shared_ptr<const Geometry> evaluateGeometry(const AbstractNode& node, bool allownef,
+                                                   bool allowInstances = false);
+
+  // Loads the files imported below node in the background while alive, see ImportPrefetcher.
+  // Does nothing if an outer scope is already prefetching.
+  class PrefetchScope
+  {
+  public:
+    PrefetchScope(GeometryEvaluator& evaluator, const AbstractNode& node)
+      : evaluator(evaluator), active(evaluator.startPrefetch(node))
+    {
+    }
+    ~PrefetchScope()
+    {
+      if (active) evaluator.prefetcher.reset();
+    }
+
+  private:
+    GeometryEvaluator& evaluator;
+    bool active;
+  };
+
+  // Times the results of an evaluation while alive. Evaluations nested in another one
+  // continue its timing, so the node being evaluated keeps the time spent so far.
+  class TimingScope
+  {
+  public:
+    TimingScope(GeometryEvaluator& evaluator) : evaluator(evaluator)
+    {
+      if (evaluator.evaluationDepth++ == 0) evaluator.lastresult = std::chrono::steady_clock::now();
+    }
+    ~TimingScope() { --evaluator.evaluationDepth; }
+
+  private:
+    GeometryEvaluator& evaluator;
+  };
 
   Response visit(State& state, const AbstractNode& node) override;
   Response visit(State& state, const ColorNode& node) override;
@@ -44,6 +81,7 @@ public:
   Response visit(State& state, const ProjectionNode& node) override;
   Response visit(State& state, const RenderNode& node) override;
   Response visit(State& state, const TextNode& node) override;
+  Response visit(State& state, const ImportNode& node) override;
   Response visit(State& state, const OffsetNode& node) override;
 
   [[nodiscard]] const Tree& getTree() const { return this->tree; }
@@ -81,6 +119,7 @@ private:
     {
       return is_const ? const_pointer : std::static_pointer_cast<const Geometry>(pointer);
     }
+    [[nodiscard]] bool isConst() const { return is_const; }
     std::shared_ptr<Geometry> asMutableGeometry()
     {
       if (is_const) return {constptr() ? constptr()->copy() : nullptr};
@@ -102,6 +141,7 @@ private:
     std::shared_ptr<const Geometry> const_pointer;
   };
 
+  bool startPrefetch(const AbstractNode& node);
   void smartCacheInsert(const AbstractNode& node, const std::shared_ptr<const Geometry>& geom);
   std::shared_ptr<const Geometry> smartCacheGet(const AbstractNode& node, bool preferNef);
   bool isSmartCached(const AbstractNode& node);
@@ -120,13 +160,21 @@ private:
   std::shared_ptr<const Geometry> projectionCut(const ProjectionNode& node);
   std::shared_ptr<const Geometry> projectionNoCut(const ProjectionNode& node);
 
+  [[nodiscard]] const char *profileName() const override { return "GeometryEvaluator"; }
   void addToParent(const State& state, const AbstractNode& node,
                    const std::shared_ptr<const Geometry>& geom);
   Response lazyEvaluateRootNode(State& state, const AbstractNode& node);
 
   std::map<int, Geometry::Geometries> visitedchildren;
+  // Seconds taken by the results of nodes including their children, reported to the
+  // caches, and the seconds of the children of nodes still being evaluated
+  std::map<int, double> computeseconds;
+  std::map<int, double> childseconds;
+  std::chrono::steady_clock::time_point lastresult;
+  int evaluationDepth = 0;
   const Tree& tree;
   std::shared_ptr<const Geometry> root;
+  std::unique_ptr<ImportPrefetcher> prefetcher;
 
 public:
 };
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/linalg.h"
 #include "libtess2/Include/tesselator.h"
 #include "utils/printutils.h"
@@ -527,8 +528,9 @@ Transform3d GeometryUtils::getResizeTransform(const BoundingBox& bbox, const Vec
 // Will prefer Manifold if multiple backends are enabled.
 // geom must be a 3D PolySet or the correct backend-specific geometry.
 std::shared_ptr<const Geometry> GeometryUtils::getBackendSpecificGeometry(
-  const std::shared_ptr<const Geometry>& geom)
+  const std::shared_ptr<const Geometry>& input)
 {
+  const auto geom = InstancedGeometry::materialize(input);
 #if ENABLE_MANIFOLD
   if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
     if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
@@ -1,13 +1,12 @@
 #pragma once
 
 #include "geometry/linalg.h"
-#include "utils/hash.h"
-#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <array>
 #include <cmath>
-
+#include <cstddef>
 #include <cstdint>  // int64_t
-#include <unordered_map>
-#include <utility>
+#include <vector>
 
 // const double GRID_COARSE = 0.001;
 // const double GRID_FINE   = 0.000001;
@@ -19,12 +18,102 @@
 const double GRID_COARSE = 0.0009765625;
 const double GRID_FINE = 0.00000095367431640625;
 
+/*!
+   Open-addressing hash map from N-dimensional integer grid cells to values of type T.
+
+   Cells are stored inline in a flat power-of-two table, so probing the
+   neighborhood of a point doesn't chase pointers, and a small bit filter in front
+   of the table rejects most lookups of empty cells. Values are kept in insertion
+   order in a separate array; references to them are invalidated by inserting.
+ */
+template <size_t N, typename T>
+class GridMap
+{
+public:
+  using Key = std::array<int64_t, N>;
+
+  [[nodiscard]] size_t size() const { return values.size(); }
+  [[nodiscard]] bool empty() const { return values.empty(); }
+
+  // Returns the index of the value stored for key, or -1
+  [[nodiscard]] int64_t find(const Key& key) const
+  {
+    const auto h = hash(key);
+    // Most neighbor probes miss, and the filter answers those without touching the table
+    if (slots.empty() || !inFilter(h)) return -1;
+    for (size_t i = bucket(h);; i = (i + 1) & (slots.size() - 1)) {
+      const auto& slot = slots[i];
+      if (slot.index < 0) return -1;
+      if (slot.key == key) return slot.index;
+    }
+  }
+
+  // Returns the index of the value stored for key, inserting a default value if there is none
+  int64_t insert(const Key& key)
+  {
+    if (2 * (values.size() + 1) > slots.size()) grow();
+    const auto h = hash(key);
+    for (size_t i = bucket(h);; i = (i + 1) & (slots.size() - 1)) {
+      auto& slot = slots[i];
+      if (slot.index < 0) {
+        slot = {key, static_cast<int64_t>(values.size())};
+        setFilter(h);
+        values.emplace_back();
+        return slot.index;
+      }
+      if (slot.key == key) return slot.index;
+    }
+  }
+
+  T& value(int64_t index) { return values[index]; }
+  const T& value(int64_t index) const { return values[index]; }
+
+private:
+  struct Slot {
+    Key key;
+    int64_t index;
+  };
+
+  static uint64_t hash(const Key& key)
+  {
+    uint64_t h = 0;
+    for (const auto k : key) h = (h ^ static_cast<uint64_t>(k)) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+  }
+  // The filter uses the low bits of the hash, the table the high bits
+  size_t bucket(uint64_t h) const { return static_cast<size_t>(h >> 32) & (slots.size() - 1); }
+  void setFilter(uint64_t h) { filter[(h >> 6) & (filter.size() - 1)] |= filterBit(h); }
+  bool inFilter(uint64_t h) const { return filter[(h >> 6) & (filter.size() - 1)] & filterBit(h); }
+  static uint64_t filterBit(uint64_t h) { return uint64_t{1} << (h & 63); }
+
+  void grow()
+  {
+    std::vector<Slot> old(std::max<size_t>(64, 2 * slots.size()), Slot{Key{}, -1});
+    old.swap(slots);
+    // 8 filter bits per slot, i.e. at least 16 per stored cell
+    filter.assign(slots.size() / 8, 0);
+    for (const auto& slot : old) {
+      if (slot.index < 0) continue;
+      const auto h = hash(slot.key);
+      size_t i = bucket(h);
+      while (slots[i].index >= 0) i = (i + 1) & (slots.size() - 1);
+      slots[i] = slot;
+      setFilter(h);
+    }
+  }
+
+  std::vector<Slot> slots;
+  std::vector<uint64_t> filter;
+  std::vector<T> values;
+};
+
 template <typename T>
 class Grid2d
 {
 public:
   double res;
-  std::unordered_map<std::pair<int64_t, int64_t>, T, boost::hash<std::pair<int64_t, int64_t>>> db;
+  using Key = typename GridMap<2, T>::Key;
+  GridMap<2, T> db;
 
   Grid2d(double resolution) { res = resolution; }
   /*!
@@ -36,11 +125,11 @@ public:
   {
     auto ix = (int64_t)std::round(x / res);
     auto iy = (int64_t)std::round(y / res);
-    if (db.find(std::make_pair(ix, iy)) == db.end()) {
+    if (db.find({ix, iy}) < 0 && !db.empty()) {
       int dist = 10;
       for (int64_t jx = ix - 1; jx <= ix + 1; ++jx) {
         for (int64_t jy = iy - 1; jy <= iy + 1; ++jy) {
-          if (db.find(std::make_pair(jx, jy)) == db.end()) continue;
+          if (db.find({jx, jy}) < 0) continue;
           int d = abs(int(ix - jx)) + abs(int(iy - jy));
           if (d < dist) {
             dist = d;
@@ -51,17 +140,16 @@ public:
       }
     }
     x = ix * res, y = iy * res;
-    return db[std::make_pair(ix, iy)];
+    return db.value(db.insert({ix, iy}));
   }
 
   [[nodiscard]] bool has(double x, double y) const
   {
     auto ix = (int64_t)std::round(x / res);
     auto iy = (int64_t)std::round(y / res);
-    if (db.find(std::make_pair(ix, iy)) != db.end()) return true;
     for (int64_t jx = ix - 1; jx <= ix + 1; ++jx)
       for (int64_t jy = iy - 1; jy <= iy + 1; ++jy) {
-        if (db.find(std::make_pair(jx, jy)) != db.end()) return true;
+        if (db.find({jx, jy}) >= 0) return true;
       }
     return false;
   }
@@ -75,6 +163,7 @@ public:
   }
   T& data(double x, double y) { return align(x, y); }
   T& operator()(double x, double y) { return align(x, y); }
+  [[nodiscard]] size_t size() const { return db.size(); }
 };
 
 template <typename T>
@@ -82,13 +171,12 @@ class Grid3d
 {
 public:
   double res;
-  using Key = Vector3l;
-  using GridContainer = std::unordered_map<Key, T>;
-  GridContainer db;
+  using Key = typename GridMap<3, T>::Key;
+  GridMap<3, T> db;
 
   Grid3d(double resolution) { res = resolution; }
 
-  inline void createGridVertex(const Vector3d& v, Vector3l& i)
+  inline void createGridVertex(const Vector3d& v, Key& i) const
   {
     i[0] = int64_t(v[0] / this->res);
     i[1] = int64_t(v[1] / this->res);
@@ -99,21 +187,24 @@ public:
   // Will automatically increase the index as new unique vertices are added.
   T align(Vector3d& v)
   {
-    Vector3l key;
+    Key key;
     createGridVertex(v, key);
-    auto iter = db.find(key);
-    if (iter == db.end()) {
+    auto index = db.find(key);
+    if (index < 0 && !db.empty()) {
+      const Key center = key;
       float dist = 10.0f;  // > max possible distance
-      for (int64_t jx = key[0] - 1; jx <= key[0] + 1; ++jx) {
-        for (int64_t jy = key[1] - 1; jy <= key[1] + 1; ++jy) {
-          for (int64_t jz = key[2] - 1; jz <= key[2] + 1; ++jz) {
-            Vector3l k(jx, jy, jz);
-            auto tmpiter = db.find(k);
-            if (tmpiter == db.end()) continue;
-            float d = sqrt((key - k).squaredNorm());
+      for (int64_t jx = center[0] - 1; jx <= center[0] + 1; ++jx) {
+        for (int64_t jy = center[1] - 1; jy <= center[1] + 1; ++jy) {
+          for (int64_t jz = center[2] - 1; jz <= center[2] + 1; ++jz) {
+            const Key k{jx, jy, jz};
+            auto found = db.find(k);
+            if (found < 0) continue;
+            const int64_t dx = center[0] - jx, dy = center[1] - jy, dz = center[2] - jz;
+            float d = sqrt(dx * dx + dy * dy + dz * dz);
             if (d < dist) {
               dist = d;
-              iter = tmpiter;
+              index = found;
+              key = k;
             }
           }
         }
@@ -121,13 +212,12 @@ public:
     }
 
     T data;
-    if (iter == db.end()) {  // Not found: insert using key
+    if (index < 0) {  // Not found: insert using key
       data = db.size();
-      db[key] = data;
+      db.value(db.insert(key)) = data;
     } else {
       // If found return existing data
-      key = iter->first;
-      data = iter->second;
+      data = db.value(index);
     }
 
     // Align vertex
@@ -138,25 +228,21 @@ public:
     return data;
   }
 
-  bool has(const Vector3d& v, T *data = nullptr)
+  bool has(const Vector3d& v, T *data = nullptr) const
   {
-    Vector3l key = createGridVertex(v);
-    typename GridContainer::iterator pos = db.find(key);
-    if (pos != db.end()) {
-      if (data) *data = pos->second;
-      return true;
-    }
-    for (int64_t jx = key[0] - 1; jx <= key[0] + 1; ++jx)
-      for (int64_t jy = key[1] - 1; jy <= key[1] + 1; ++jy)
-        for (int64_t jz = key[2] - 1; jz <= key[2] + 1; ++jz) {
-          pos = db.find(Vector3l(jx, jy, jz));
-          if (pos != db.end()) {
-            if (data) *data = pos->second;
-            return true;
-          }
+    Key key;
+    createGridVertex(v, key);
+    auto index = db.find(key);
+    for (int64_t jx = key[0] - 1; index < 0 && jx <= key[0] + 1; ++jx)
+      for (int64_t jy = key[1] - 1; index < 0 && jy <= key[1] + 1; ++jy)
+        for (int64_t jz = key[2] - 1; index < 0 && jz <= key[2] + 1; ++jz) {
+          index = db.find({jx, jy, jz});
         }
-    return false;
+    if (index < 0) return false;
+    if (data) *data = db.value(index);
+    return true;
   }
 
   T data(Vector3d v) { return align(v); }
+  [[nodiscard]] size_t size() const { return db.size(); }
 };
@@ -0,0 +1,87 @@
+#include "geometry/ImportPrefetcher.h"
+
+#include <exception>
+#include <future>
+#include <memory>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "core/ImportNode.h"
+#include "core/SurfaceNode.h"
+#include "core/node.h"
+#include "geometry/Geometry.h"
+#include "utils/parallel.h"
+#include "utils/printutils.h"
+
+ImportPrefetcher::ImportPrefetcher(const std::vector<const LeafNode *>& nodes)
+{
+  for (const auto *node : nodes) {
+    if (this->pending.count(node)) continue;
+    auto& job = this->jobs.emplace_back(std::make_unique<Job>());
+    job->node = node;
+    this->pending.emplace(node, std::make_pair(job.get(), job->done.get_future()));
+  }
+  if (this->jobs.empty()) return;
+
+  // Jobs are started in tree order, so without parallelism the first node needed is loaded first
+  try {
+    this->worker = std::async(std::launch::async, [this]() {
+      parallelizable_for_each(this->jobs.begin(), this->jobs.end(),
+                              [this](const std::unique_ptr<Job>& job) { run(*job); });
+    });
+  } catch (const std::system_error&) {
+    // No threads available (e.g. WASM builds), so everything is loaded on demand
+    this->pending.clear();
+  }
+}
+
+ImportPrefetcher::~ImportPrefetcher()
+{
+  this->cancelled = true;
+  if (this->worker.valid()) this->worker.wait();
+}
+
+bool ImportPrefetcher::isPrefetchable(const LeafNode& node)
+{
+  if (dynamic_cast<const SurfaceNode *>(&node)) return true;
+  if (const auto *import = dynamic_cast<const ImportNode *>(&node)) {
+    // SVG and DXF import use global state, AMF import requires libxml2 to be initialized on the main
+    // thread and NEF3 import uses CGAL, so these are always loaded on demand.
+    switch (import->type) {
+    case ImportType::STL:
+    case ImportType::OFF:
+    case ImportType::OBJ:
+    case ImportType::_3MF: return true;
+    default:               return false;
+    }
+  }
+  return false;
+}
+
+void ImportPrefetcher::run(Job& job)
+{
+  if (!this->cancelled) {
+    MessageCapture capture;
+    try {
+      job.geom = job.node->createGeometry();
+    } catch (...) {
+      job.error = std::current_exception();
+    }
+    job.messages = capture.release();
+  }
+  job.done.set_value();
+}
+
+std::unique_ptr<const Geometry> ImportPrefetcher::take(const LeafNode& node)
+{
+  const auto it = this->pending.find(&node);
+  if (it == this->pending.end()) return nullptr;
+  auto [job, done] = std::move(it->second);
+  this->pending.erase(it);
+
+  done.wait();
+  MessageCapture::replay(job->messages);
+  if (job->error) std::rethrow_exception(job->error);
+  return std::move(job->geom);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "geometry/Geometry.h"
+#include "utils/printutils.h"
+
+class LeafNode;
+
+/*!
+   Loads the files of import() and surface() nodes on background threads.
+
+   The evaluator hands over all such leaves up front; they are parsed concurrently
+   while the rest of the tree is evaluated, and the evaluator calls take() once it
+   reaches a leaf. Messages printed while loading are replayed on the calling thread
+   by take(), so output stays in tree order.
+ */
+class ImportPrefetcher
+{
+public:
+  ImportPrefetcher(const std::vector<const LeafNode *>& nodes);
+  // Waits for loads in progress, and skips loads not yet started
+  ~ImportPrefetcher();
+
+  // Returns true if the node reads a file and can safely do so off the main thread
+  static bool isPrefetchable(const LeafNode& node);
+
+  // Returns the geometry of a prefetched node, waiting for it if necessary.
+  // Returns nullptr if the node was not prefetched.
+  std::unique_ptr<const Geometry> take(const LeafNode& node);
+
+private:
+  struct Job {
+    const LeafNode *node;
+    std::promise<void> done;
+    std::unique_ptr<const Geometry> geom;
+    std::vector<std::pair<Message, bool>> messages;
+    std::exception_ptr error;
+  };
+
+  void run(Job& job);
+
+  std::vector<std::unique_ptr<Job>> jobs;
+  std::unordered_map<const LeafNode *, std::pair<Job *, std::future<void>>> pending;
+  std::atomic<bool> cancelled{false};
+  std::future<void> worker;
+};
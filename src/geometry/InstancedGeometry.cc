@@ -0,0 +1,101 @@
+#include "geometry/InstancedGeometry.h"
+
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "geometry/Geometry.h"
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+
+InstancedGeometry::InstancedGeometry(std::shared_ptr<const PolySet> base, const Transform3d& matrix)
+  : base(std::move(base)), matrix(matrix)
+{
+  this->convexity = this->base->getConvexity();
+}
+
+std::shared_ptr<const InstancedGeometry> InstancedGeometry::create(
+  const std::shared_ptr<const Geometry>& geom, const Transform3d& matrix)
+{
+  if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    auto result = std::make_shared<InstancedGeometry>(instance->base, matrix * instance->matrix);
+    result->setConvexity(instance->getConvexity());
+    return result;
+  }
+  if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
+    if (ps->getDimension() == 3) return std::make_shared<InstancedGeometry>(ps, matrix);
+  }
+  return nullptr;
+}
+
+std::shared_ptr<const Geometry> InstancedGeometry::materialize(const std::shared_ptr<const Geometry>& geom)
+{
+  if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return instance->toPolySet();
+  }
+  if (const auto list = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    Geometry::Geometries children;
+    bool changed = false;
+    for (const auto& [node, child] : list->getChildren()) {
+      auto materialized = materialize(child);
+      changed |= materialized != child;
+      children.emplace_back(node, std::move(materialized));
+    }
+    if (changed) return std::make_shared<GeometryList>(std::move(children));
+  }
+  return geom;
+}
+
+size_t InstancedGeometry::memsize() const
+{
+  // The mesh is shared between all instances and whoever else holds it, so each
+  // instance accounts for its share at the time of asking.
+  return sizeof(InstancedGeometry) + this->base->memsize() / this->base.use_count();
+}
+
+BoundingBox InstancedGeometry::getBoundingBox() const
+{
+  if (this->matrix.linear().isIdentity()) {
+    return this->base->getBoundingBox().translated(this->matrix.translation());
+  }
+  BoundingBox bbox;
+  for (const auto& v : this->base->vertices) bbox.extend(this->matrix * v);
+  return bbox;
+}
+
+std::string InstancedGeometry::dump() const
+{
+  std::ostringstream out;
+  out << "InstancedGeometry:\n matrix:\n" << this->matrix.matrix() << "\n" << this->base->dump();
+  return out.str();
+}
+
+bool InstancedGeometry::isEmpty() const
+{
+  return this->base->isEmpty();
+}
+
+std::unique_ptr<Geometry> InstancedGeometry::copy() const
+{
+  return toPolySet();
+}
+
+size_t InstancedGeometry::numFacets() const
+{
+  return this->base->numFacets();
+}
+
+void InstancedGeometry::accept(GeometryVisitor& visitor) const
+{
+  toPolySet()->accept(visitor);
+}
+
+std::unique_ptr<PolySet> InstancedGeometry::toPolySet() const
+{
+  auto ps = std::make_unique<PolySet>(*this->base);
+  ps->transform(this->matrix);
+  ps->setConvexity(this->convexity);
+  return ps;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "geometry/Geometry.h"
+#include "geometry/linalg.h"
+
+class PolySet;
+
+/*!
+   A 3D PolySet placed by a transformation, sharing the PolySet's mesh.
+
+   Transforming a const (e.g. cached) PolySet would otherwise require a deep copy,
+   so many transformed copies of the same object cost only one mesh. The transformed
+   vertices are only computed once an operation needs them, see materialize().
+
+   copy() returns the transformed PolySet, so code which gets a mutable geometry
+   through copy() never sees an InstancedGeometry.
+ */
+class InstancedGeometry : public Geometry
+{
+public:
+  InstancedGeometry(std::shared_ptr<const PolySet> base, const Transform3d& matrix);
+
+  // Returns an instance of geom transformed by matrix if geom is a 3D PolySet or an
+  // InstancedGeometry, or nullptr otherwise.
+  static std::shared_ptr<const InstancedGeometry> create(const std::shared_ptr<const Geometry>& geom,
+                                                         const Transform3d& matrix);
+  // Returns geom itself, unless it is (or is a GeometryList containing) an instance, which
+  // is replaced by its transformed PolySet.
+  static std::shared_ptr<const Geometry> materialize(const std::shared_ptr<const Geometry>& geom);
+
+  [[nodiscard]] size_t memsize() const override;
+  [[nodiscard]] BoundingBox getBoundingBox() const override;
+  [[nodiscard]] std::string dump() const override;
+  [[nodiscard]] unsigned int getDimension() const override { return 3; }
+  [[nodiscard]] bool isEmpty() const override;
+  [[nodiscard]] std::unique_ptr<Geometry> copy() const override;
+  [[nodiscard]] size_t numFacets() const override;
+  void transform(const Transform3d& mat) override { this->matrix = mat * this->matrix; }
+  void accept(GeometryVisitor& visitor) const override;
+
+  [[nodiscard]] std::unique_ptr<PolySet> toPolySet() const;
+  [[nodiscard]] const std::shared_ptr<const PolySet>& getBase() const { return this->base; }
+  [[nodiscard]] const Transform3d& getMatrix() const { return this->matrix; }
+
+private:
+  std::shared_ptr<const PolySet> base;
+  Transform3d matrix;
+};
@@ -139,14 +139,17 @@ void PolySet::quantizeVertices(std::vector<Vector3d> *pPointsOut)
   const bool has_colors = !this->color_indices.empty();
   Grid3d<unsigned int> grid(GRID_FINE);
   std::vector<unsigned int> polygon_indices;  // Vertex indices in one polygon
-  for (size_t i = 0; i < this->indices.size();) {
-    IndexedFace& ind_f = this->indices[i];
+  // Vertices are snapped to the grid in place
+  auto& vertices = this->vertices.mut();
+  auto& indices = this->indices.mut();
+  for (size_t i = 0; i < indices.size();) {
+    IndexedFace& ind_f = indices[i];
     polygon_indices.resize(ind_f.size());
     // Quantize all vertices. Build index list
     for (unsigned int i = 0; i < ind_f.size(); ++i) {
-      polygon_indices[i] = grid.align(this->vertices[ind_f[i]]);
-      if (pPointsOut && pPointsOut->size() < grid.db.size()) {
-        pPointsOut->push_back(this->vertices[ind_f[i]]);
+      polygon_indices[i] = grid.align(vertices[ind_f[i]]);
+      if (pPointsOut && pPointsOut->size() < grid.size()) {
+        pPointsOut->push_back(vertices[ind_f[i]]);
       }
     }
     // Remove consecutive duplicate vertices
@@ -159,7 +162,7 @@ void PolySet::quantizeVertices(std::vector<Vector3d> *pPointsOut)
     ind_f.erase(currp, ind_f.end());
     if (ind_f.size() < 3) {
       PRINTD("Removing collapsed polygon due to quantizing");
-      this->indices.erase(this->indices.begin() + i);
+      indices.erase(indices.begin() + i);
       if (has_colors) this->color_indices.erase(this->color_indices.begin() + i);
     } else {
       i++;
@@ -5,6 +5,7 @@
 #include "geometry/GeometryUtils.h"
 #include "geometry/Polygon2d.h"
 #include "utils/boost-utils.h"
+#include "utils/cow_vector.h"
 
 #include <cstdint>
 #include <memory>
@@ -20,11 +21,12 @@ class PolySet : public Geometry
 
 public:
   VISITABLE_GEOMETRY();
-  PolygonIndices indices;
-  std::vector<Vector3d> vertices;
+  // The arrays are copy-on-write, so copying a PolySet is cheap until one of the copies is modified.
+  CowVector<IndexedFace> indices;
+  CowVector<Vector3d> vertices;
   // Per polygon color, indexing the colors vector below. Can be empty, and -1 means no specific color.
-  std::vector<int32_t> color_indices;
-  std::vector<Color4f> colors;
+  CowVector<int32_t> color_indices;
+  CowVector<Color4f> colors;
 
   PolySet(unsigned int dim, boost::tribool convex = unknown);
 
@@ -28,6 +28,7 @@
 #include "geometry/linalg.h"
 #include "geometry/PolySet.h"
 #include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
 
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgalutils.h"
@@ -100,6 +101,8 @@ void PolySetBuilder::appendGeometry(const std::shared_ptr<const Geometry>& geom)
     }
   } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     appendPolySet(*ps);
+  } else if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    appendPolySet(*instance->toPolySet());
 #ifdef ENABLE_CGAL
   } else if (const auto N = std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) {
     if (const auto ps = CGALUtils::createPolySetFromNefPolyhedron3(*(N->p3))) {
@@ -208,10 +211,14 @@ void PolySetBuilder::appendPolySet(const PolySet& ps)
   }
 
   reserve(numVertices() + ps.vertices.size(), numPolygons() + ps.indices.size());
+  // Vertices are shared by several polygons, so look each one up only once
+  std::vector<int> vertex_map(ps.vertices.size(), -1);
   for (const auto& poly : ps.indices) {
     beginPolygon(poly.size());
     for (const auto& ind : poly) {
-      addVertex(ps.vertices[ind]);
+      auto& mapped = vertex_map[ind];
+      if (mapped < 0) mapped = vertexIndex(ps.vertices[ind]);
+      addVertex(mapped);
     }
     endPolygon();
   }
@@ -222,7 +229,7 @@ std::unique_ptr<PolySet> PolySetBuilder::build()
   endPolygon();
   std::unique_ptr<PolySet> polyset;
   polyset = std::make_unique<PolySet>(dim_, convex_);
-  vertices_.copy(std::back_inserter(polyset->vertices));
+  polyset->vertices = vertices_.takeArray();
   polyset->indices = std::move(indices_);
   polyset->color_indices = std::move(color_indices_);
   polyset->colors = std::move(colors_);
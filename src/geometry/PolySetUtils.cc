@@ -1,19 +1,23 @@
 #include "geometry/PolySetUtils.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <memory>
 #include <cstddef>
+#include <iterator>
 #include <sstream>
 #include <vector>
 
 #include <boost/range/adaptor/reversed.hpp>
 
 #include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/linalg.h"
 #include "geometry/PolySet.h"
 #include "geometry/PolySetBuilder.h"
 #include "geometry/Polygon2d.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 #include "geometry/GeometryUtils.h"
 #ifdef ENABLE_CGAL
@@ -70,7 +74,7 @@ std::unique_ptr<PolySet> tessellate_faces(const PolySet& polyset)
   result->setConvexity(polyset.getConvexity());
   result->setTriangular(true);
   result->setManifold(polyset.isManifold());
-  // ideally this should not require a copy...
+  // The arrays are copy-on-write, so this shares the storage with the input
   if (polyset.isTriangular()) {
     result->vertices = polyset.vertices;
     result->indices = polyset.indices;
@@ -78,7 +82,8 @@ std::unique_ptr<PolySet> tessellate_faces(const PolySet& polyset)
     result->colors = polyset.colors;
     return result;
   }
-  result->vertices.reserve(polyset.vertices.size());
+  auto& result_vertices = result->vertices.mut();
+  result_vertices.reserve(polyset.vertices.size());
   result->indices.reserve(polyset.indices.size());
 
   std::vector<bool> used(polyset.vertices.size(), false);
@@ -124,7 +129,7 @@ std::unique_ptr<PolySet> tessellate_faces(const PolySet& polyset)
     if (used[i]) {
       indexMap[i] = verts.size();
       verts.emplace_back(polyset.vertices[i].cast<float>());
-      result->vertices.push_back(polyset.vertices[i]);
+      result_vertices.push_back(polyset.vertices[i]);
     }
   }
   if (verts.size() != polyset.vertices.size()) {
@@ -134,29 +139,55 @@ std::unique_ptr<PolySet> tessellate_faces(const PolySet& polyset)
     }
   }
 
-  // we will reuse this memory instead of reallocating for each polygon
-  std::vector<IndexedTriangle> triangles;
-  std::vector<IndexedFace> facesBuffer(1);
-  for (size_t i = 0, n = polygons.size(); i < n; i++) {
-    const auto& face = polygons[i];
-    if (face.size() == 3) {
-      // trivial case - triangles cannot be concave or have holes
-      result->indices.push_back({face[0], face[1], face[2]});
-      if (has_colors) result->color_indices.push_back(polygon_color_indices[i]);
-    }
-    // Quads seem trivial, but can be concave, and can have degenerate cases.
-    // So everything more complex than triangles goes into the general case.
-    else {
-      triangles.clear();
-      facesBuffer[0] = face;
-      auto err = GeometryUtils::tessellatePolygonWithHoles(verts, facesBuffer, triangles, nullptr);
-      if (!err) {
-        for (const auto& t : triangles) {
-          result->indices.push_back({t[0], t[1], t[2]});
-          if (has_colors) result->color_indices.push_back(polygon_color_indices[i]);
+  // Faces are tessellated in parallel chunks, each with its own output buffers which
+  // are appended in order, so the result doesn't depend on the number of threads.
+  struct Chunk {
+    size_t begin, end;
+    PolygonIndices indices;
+    std::vector<int32_t> color_indices;
+  };
+  constexpr size_t chunkSize = 4096;
+  std::vector<Chunk> chunks;
+  for (size_t begin = 0; begin < polygons.size(); begin += chunkSize) {
+    chunks.push_back({begin, std::min(begin + chunkSize, polygons.size()), {}, {}});
+  }
+  parallelizable_for_each(chunks.begin(), chunks.end(), [&](Chunk& chunk) {
+    chunk.indices.reserve(chunk.end - chunk.begin);
+    // we will reuse this memory instead of reallocating for each polygon
+    std::vector<IndexedTriangle> triangles;
+    std::vector<IndexedFace> facesBuffer(1);
+    for (size_t i = chunk.begin; i < chunk.end; i++) {
+      const auto& face = polygons[i];
+      const auto color = has_colors ? polygon_color_indices[i] : 0;
+      if (face.size() == 3) {
+        // trivial case - triangles cannot be concave or have holes
+        chunk.indices.push_back({face[0], face[1], face[2]});
+        if (has_colors) chunk.color_indices.push_back(color);
+      }
+      // Quads seem trivial, but can be concave, and can have degenerate cases.
+      // So everything more complex than triangles goes into the general case.
+      else {
+        triangles.clear();
+        facesBuffer[0] = face;
+        auto err = GeometryUtils::tessellatePolygonWithHoles(verts, facesBuffer, triangles, nullptr);
+        if (!err) {
+          for (const auto& t : triangles) {
+            chunk.indices.push_back({t[0], t[1], t[2]});
+            if (has_colors) chunk.color_indices.push_back(color);
+          }
         }
       }
     }
+  });
+
+  size_t numTriangles = 0;
+  for (const auto& chunk : chunks) numTriangles += chunk.indices.size();
+  result->indices.reserve(numTriangles);
+  if (has_colors) result->color_indices.reserve(numTriangles);
+  for (auto& chunk : chunks) {
+    std::move(chunk.indices.begin(), chunk.indices.end(), std::back_inserter(result->indices));
+    result->color_indices.insert(result->color_indices.end(), chunk.color_indices.begin(),
+                                 chunk.color_indices.end());
   }
   if (degeneratePolygons > 0) {
     LOG(message_group::Warning, "PolySet has degenerate polygons");
@@ -182,6 +213,8 @@ std::shared_ptr<const PolySet> getGeometryAsPolySet(const std::shared_ptr<const
     return builder.build();
   } else if (auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     return ps;
+  } else if (auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return instance->toPolySet();
   }
 #ifdef ENABLE_CGAL
   if (auto N = std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) {
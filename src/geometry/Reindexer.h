@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstddef>
-#include <unordered_map>
+#include <cstdint>
+#include <functional>
+#include <utility>
 #include <vector>
 #include <algorithm>
 #include "utils/hash.h"  // IWYU pragma: keep
@@ -12,6 +14,10 @@
    a new array or to merge two index tables to two arrays into a common index.
    The latter is necessary for VBO's or for unifying texture coordinate indices to
    multiple texture coordinate arrays.
+
+   Elements are stored once, in the new element array; lookups go through an
+   open-addressing hash table of indices into that array, so inserting doesn't
+   allocate per element.
  */
 template <typename T>
 class Reindexer
@@ -22,34 +28,46 @@ public:
      Returns the new index. */
   int lookup(const T& val)
   {
-    auto iter = this->map.find(val);
-    if (iter != this->map.end()) return iter->second;
-    else {
-      this->map.insert(std::make_pair(val, this->map.size()));
-      return this->map.size() - 1;
+    if (2 * (this->vec.size() + 1) > this->slots.size()) rehash(2 * (this->vec.size() + 1));
+    const auto hash = static_cast<uint64_t>(std::hash<T>{}(val));
+    for (size_t i = bucket(hash);; i = (i + 1) & (this->slots.size() - 1)) {
+      auto& slot = this->slots[i];
+      if (slot.index < 0) {
+        slot = {hash, static_cast<int>(this->vec.size())};
+        this->vec.push_back(val);
+        return slot.index;
+      }
+      if (slot.hash == hash && std::equal_to<T>{}(this->vec[slot.index], val)) return slot.index;
     }
   }
 
   /*!
      Returns the current size of the new element array
    */
-  [[nodiscard]] std::size_t size() const { return this->map.size(); }
+  [[nodiscard]] std::size_t size() const { return this->vec.size(); }
 
   /*!
      Reserve the requested size for the new element map
    */
-  void reserve(std::size_t n) { return this->map.reserve(n); }
+  void reserve(std::size_t n)
+  {
+    this->vec.reserve(n);
+    rehash(2 * n);
+  }
+
+  /*!
+     Return the new element array
+   */
+  const std::vector<T>& getArray() const { return this->vec; }
 
   /*!
-     Return a copy of the new element array
+     Moves out the new element array, leaving the reindexer empty
    */
-  const std::vector<T>& getArray()
+  std::vector<T> takeArray()
   {
-    this->vec.resize(this->map.size());
-    for (const auto& entry : map) {
-      this->vec[entry.second] = entry.first;
-    }
-    return this->vec;
+    this->slots.clear();
+    this->shift = 64;
+    return std::move(this->vec);
   }
 
   /*!
@@ -58,11 +76,43 @@ public:
   template <class OutputIterator>
   void copy(OutputIterator dest)
   {
-    this->getArray();
     std::copy(this->vec.begin(), this->vec.end(), dest);
   }
 
 private:
-  std::unordered_map<T, int> map;
+  struct Slot {
+    uint64_t hash;
+    int index;
+  };
+
+  // Fibonacci hashing spreads the bits of weak hashes over the table
+  size_t bucket(uint64_t hash) const
+  {
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> this->shift);
+  }
+
+  // Grows the table to a power of two of at least min_slots
+  void rehash(std::size_t min_slots)
+  {
+    size_t count = 16;
+    unsigned int bits = 4;
+    while (count < min_slots) {
+      count *= 2;
+      ++bits;
+    }
+    if (count <= this->slots.size()) return;
+    std::vector<Slot> old(count, Slot{0, -1});
+    old.swap(this->slots);
+    this->shift = 64 - bits;
+    for (const auto& slot : old) {
+      if (slot.index < 0) continue;
+      size_t i = bucket(slot.hash);
+      while (this->slots[i].index >= 0) i = (i + 1) & (count - 1);
+      this->slots[i] = slot;
+    }
+  }
+
   std::vector<T> vec;
+  std::vector<Slot> slots;
+  unsigned int shift = 64;
 };
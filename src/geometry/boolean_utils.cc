@@ -1,13 +1,12 @@
 #include "geometry/boolean_utils.h"
 
+#include <cstddef>
 #include <utility>
 #include <memory>
 #include <vector>
 
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGALNefGeometry.h"
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/convex_hull_3.h>
 #include "geometry/cgal/cgalutils.h"
 #endif  // ENABLE_CGAL
 #ifdef ENABLE_MANIFOLD
@@ -19,71 +18,58 @@
 #include "geometry/PolySet.h"
 #include "utils/printutils.h"
 
-#include "geometry/Reindexer.h"
-#include "geometry/GeometryUtils.h"
+#include "geometry/ConvexHull.h"
+#include "geometry/linalg.h"
 
-#ifdef ENABLE_CGAL
 std::unique_ptr<PolySet> applyHull(const Geometry::Geometries& children)
 {
-  using Hull_kernel = CGAL::Epick;
   // Collect point cloud
-  Reindexer<Hull_kernel::Point_3> reindexer;
-
-  auto addCapacity = [&](const auto n) { reindexer.reserve(reindexer.size() + n); };
-
-  auto addPoint = [&](const auto& v) { reindexer.lookup(v); };
-
+  std::vector<Vector3d> points;
   for (const auto& item : children) {
     auto& chgeom = item.second;
 #ifdef ENABLE_CGAL
     if (const auto *N = dynamic_cast<const CGALNefGeometry *>(chgeom.get())) {
       if (!N->isEmpty()) {
-        addCapacity(N->p3->number_of_vertices());
+        points.reserve(points.size() + N->p3->number_of_vertices());
         for (auto it = N->p3->vertices_begin(); it != N->p3->vertices_end(); ++it) {
-          addPoint(CGALUtils::vector_convert<Hull_kernel::Point_3>(it->point()));
+          points.push_back(CGALUtils::vector_convert<Vector3d>(it->point()));
         }
       }
+      continue;
+    }
 #endif  // ENABLE_CGAL
 #ifdef ENABLE_MANIFOLD
-    } else if (const auto *mani = dynamic_cast<const ManifoldGeometry *>(chgeom.get())) {
-      addCapacity(mani->numVertices());
+    if (const auto *mani = dynamic_cast<const ManifoldGeometry *>(chgeom.get())) {
+      points.reserve(points.size() + mani->numVertices());
       mani->foreachVertexUntilTrue([&](auto& p) {
-        addPoint(CGALUtils::vector_convert<Hull_kernel::Point_3>(p));
+        points.emplace_back(p[0], p[1], p[2]);
         return false;
       });
+      continue;
+    }
 #endif  // ENABLE_MANIFOLD
-    } else if (const auto *ps = dynamic_cast<const PolySet *>(chgeom.get())) {
-      addCapacity(ps->indices.size() * 3);
+    if (const auto *ps = dynamic_cast<const PolySet *>(chgeom.get())) {
+      // Only vertices used by faces, each once
+      std::vector<bool> used(ps->vertices.size());
       for (const auto& p : ps->indices) {
-        for (const auto& ind : p) {
-          addPoint(CGALUtils::vector_convert<Hull_kernel::Point_3>(ps->vertices[ind]));
-        }
+        for (const auto& ind : p) used[ind] = true;
+      }
+      for (size_t i = 0; i < used.size(); ++i) {
+        if (used[i]) points.push_back(ps->vertices[i]);
       }
     }
   }
 
-  const auto& points = reindexer.getArray();
-  if (points.size() <= 3) return nullptr;
-
   // Apply hull
-  if (points.size() >= 4) {
-    try {
-      CGAL::Polyhedron_3<Hull_kernel> r;
-      CGAL::convex_hull_3(points.begin(), points.end(), r);
-      PRINTDB("After hull vertices: %d", r.size_of_vertices());
-      PRINTDB("After hull facets: %d", r.size_of_facets());
-      PRINTDB("After hull closed: %d", r.is_closed());
-      PRINTDB("After hull valid: %d", r.is_valid());
-      // FIXME: Make sure PolySet is set to convex.
-      // FIXME: Can we guarantee a manifold PolySet here?
-      return CGALUtils::createPolySetFromPolyhedron(r);
-    } catch (const CGAL::Failure_exception& e) {
-      LOG(message_group::Error, "CGAL error in applyHull(): %1$s", e.what());
-    }
+  auto hull = ConvexHull::hull3d(points);
+  if (hull) {
+    PRINTDB("After hull vertices: %d", hull->vertices.size());
+    PRINTDB("After hull facets: %d", hull->indices.size());
   }
-  return nullptr;
+  return hull;
 }
 
+#ifdef ENABLE_CGAL
 /*!
    children cannot contain nullptr objects
 
@@ -99,11 +85,6 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
   return CGALUtils::applyMinkowski3D(children);
 }
 #else   // ENABLE_CGAL
-std::unique_ptr<PolySet> applyHull(const Geometry::Geometries& children)
-{
-  return std::make_unique<PolySet>(3, true);
-}
-
 std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children)
 {
   return std::make_shared<PolySet>(3);
@@ -4,6 +4,7 @@
 #include <memory>
 #include <cstddef>
 #include <string>
+#include <utility>
 
 #include "geometry/Geometry.h"
 #include "utils/printutils.h"
@@ -22,7 +23,10 @@ CGALCache::CGALCache(size_t limit) : cache(limit)
 
 std::shared_ptr<const Geometry> CGALCache::get(const std::string& id) const
 {
-  const auto& geom = this->cache[id]->N;
+  const auto *entry = this->cache[id];
+  ++entry->info.hits;
+  this->counters.hit(entry->info.nodeType);
+  const auto& geom = entry->N;
 #ifdef DEBUG
   LOG("CGAL Cache hit: %1$s (%2$d bytes)", id.substr(0, 40), geom ? geom->memsize() : 0);
 #endif
@@ -41,13 +45,17 @@ bool CGALCache::acceptsGeometry(const std::shared_ptr<const Geometry>& geom)
     ;
 }
 
-bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom)
+bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom,
+                       const CacheEntryInfo& info)
 {
   assert(acceptsGeometry(geom));
-  auto inserted = this->cache.insert(id, new cache_entry(geom), geom->memsize());
+  this->counters.miss(info.nodeType);
+  const size_t bytes = geom->memsize();
+  auto inserted = this->cache.insert(id, new cache_entry(geom, info), bytes);
+  ++(inserted ? this->counters.inserts : this->counters.rejected);
 #ifdef DEBUG
   LOG("CGAL Cache %1$s: %2$s (%3$d bytes)", inserted ? "inserted" : "insert failed", id.substr(0, 40),
-      geom->memsize());
+      bytes);
 #endif
   return inserted;
 }
@@ -77,13 +85,25 @@ void CGALCache::clear()
   cache.clear();
 }
 
-void CGALCache::print()
+void CGALCache::print(bool details)
 {
   LOG("CGAL Polyhedrons in cache: %1$d", this->cache.size());
   LOG("CGAL cache size in bytes: %1$d", this->cache.totalCost());
+  statistic().print("CGAL cache", details);
 }
 
-CGALCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& N) : N(N)
+CacheStatistic CGALCache::statistic() const
+{
+  return cacheStatistic(this->cache, this->counters);
+}
+
+void CGALCache::forEachEntry(const CacheEntryFunc& f) const
+{
+  forEachCacheEntry(this->cache, f);
+}
+
+CGALCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& N, CacheEntryInfo info)
+  : N(N), info(std::move(info))
 {
   if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
 }
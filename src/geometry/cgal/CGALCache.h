@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include "geometry/CacheStatistic.h"
 #include "geometry/Geometry.h"
 
 class CGALCache
@@ -20,13 +21,19 @@ public:
 
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const Geometry> get(const std::string& id) const;
-  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& N);
+  // Inserts the computed geometry, counting a miss
+  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& N,
+              const CacheEntryInfo& info = {});
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
   void setMaxSizeMB(size_t limit);
   void clear();
-  void print();
+  // Logs the size, and the statistic, with its details if details is set
+  void print(bool details = false);
+  [[nodiscard]] CacheStatistic statistic() const;
+  // Calls f for each entry, from the most to the least recently used
+  void forEachEntry(const CacheEntryFunc& f) const;
 
 private:
   static CGALCache *inst;
@@ -34,8 +41,10 @@ private:
   struct cache_entry {
     std::shared_ptr<const Geometry> N;
     std::string msg;
-    cache_entry(const std::shared_ptr<const Geometry>& N);
+    mutable CacheEntryInfo info;
+    cache_entry(const std::shared_ptr<const Geometry>& N, CacheEntryInfo info);
   };
 
   Cache<std::string, cache_entry> cache;
+  mutable CacheStatistic counters;
 };
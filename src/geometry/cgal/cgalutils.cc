@@ -3,6 +3,7 @@
 #include "geometry/cgal/cgalutils.h"
 
 #include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/linalg.h"
 #include "geometry/cgal/cgal.h"
 #include "geometry/PolySet.h"
@@ -264,6 +265,8 @@ std::shared_ptr<const CGALNefGeometry> getNefPolyhedronFromGeometry(
 {
   if (auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     return std::shared_ptr<CGALNefGeometry>(createNefPolyhedronFromPolySet(*ps));
+  } else if (auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return std::shared_ptr<CGALNefGeometry>(createNefPolyhedronFromPolySet(*instance->toPolySet()));
   } else if (auto poly2d = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
     std::shared_ptr<PolySet> ps(poly2d->tessellate());
     return std::shared_ptr<CGALNefGeometry>(createNefPolyhedronFromPolySet(*ps));
@@ -508,6 +511,9 @@ std::shared_ptr<const PolySet> getGeometryAsPolySet(const std::shared_ptr<const
   if (auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     return ps;
   }
+  if (auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return instance->toPolySet();
+  }
   if (auto N = std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) {
     auto ps = std::make_shared<PolySet>(3);
     if (!N->isEmpty()) {
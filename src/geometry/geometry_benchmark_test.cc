@@ -0,0 +1,122 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "clipper2/clipper.h"
+#include "geometry/ClipperUtils.h"
+#include "geometry/GeometryUtils.h"
+#include "geometry/linalg.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetBuilder.h"
+#include "geometry/PolySetUtils.h"
+
+namespace {
+
+// A closed star shaped outline with 2 * points vertices
+Outline2d star(double x, double y, double r, int points)
+{
+  Outline2d o;
+  for (int i = 0; i < 2 * points; ++i) {
+    const double a = M_PI * i / points;
+    const double ri = i % 2 ? r / 2 : r;
+    o.vertices.emplace_back(x + ri * std::cos(a), y + ri * std::sin(a));
+  }
+  return o;
+}
+
+// The faces of a grid of n x n quads on a sphere-like height field, as a polygon soup
+std::vector<std::vector<Vector3d>> quadSoup(int n)
+{
+  const auto vertex = [n](int i, int j) {
+    const double x = double(i) / n, y = double(j) / n;
+    return Vector3d(x, y, std::sin(x * 10) * std::cos(y * 10));
+  };
+  std::vector<std::vector<Vector3d>> quads;
+  quads.reserve(size_t(n) * n);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      quads.push_back({vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1), vertex(i, j + 1)});
+    }
+  }
+  return quads;
+}
+
+}  // namespace
+
+TEST_CASE("PolySetBuilder vertex welding", "[.][benchmark][PolySetBuilder]")
+{
+  const auto quads = quadSoup(300);
+
+  BENCHMARK("PolySetBuilder 90k quads")
+  {
+    PolySetBuilder builder;
+    for (const auto& quad : quads) builder.appendPolygon(quad);
+    return builder.build();
+  };
+
+  PolySetBuilder builder;
+  for (const auto& quad : quads) builder.appendPolygon(quad);
+  const auto ps = builder.build();
+  REQUIRE(ps->indices.size() == quads.size());
+
+  BENCHMARK("PolySetBuilder append 90k quad PolySet")
+  {
+    PolySetBuilder builder;
+    builder.appendPolySet(*ps);
+    return builder.build();
+  };
+}
+
+TEST_CASE("Polygon tessellation", "[.][benchmark][tessellation]")
+{
+  const auto quads = quadSoup(300);
+  PolySetBuilder builder;
+  for (const auto& quad : quads) builder.appendPolygon(quad);
+  const auto ps = builder.build();
+
+  BENCHMARK("tessellate_faces 90k quads") { return PolySetUtils::tessellate_faces(*ps); };
+
+  // A nonconvex outline with many vertices, like a large text glyph or imported contour
+  Polygon outline;
+  const auto o = star(0, 0, 100, 5000);
+  for (const auto& v : o.vertices) outline.emplace_back(v[0], v[1], 0);
+  BENCHMARK("tessellatePolygon 10k vertex star")
+  {
+    Polygons triangles;
+    GeometryUtils::tessellatePolygon(outline, triangles);
+    return triangles.size();
+  };
+}
+
+TEST_CASE("Clipper operations", "[.][benchmark][Clipper]")
+{
+  std::vector<std::shared_ptr<const Polygon2d>> shapes;
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      shapes.push_back(std::make_shared<Polygon2d>(star(i * 2, j * 2, 1.2, 6)));
+    }
+  }
+
+  BENCHMARK("Clipper union of 10k overlapping stars")
+  {
+    return ClipperUtils::apply(shapes, Clipper2Lib::ClipType::Union);
+  };
+
+  const std::shared_ptr<const Polygon2d> unioned =
+    ClipperUtils::apply(shapes, Clipper2Lib::ClipType::Union);
+  BENCHMARK("Clipper round offset of union")
+  {
+    return ClipperUtils::applyOffset(*unioned, 0.3, Clipper2Lib::JoinType::Round, 2.0, 0.01);
+  };
+
+  const std::vector<std::shared_ptr<const Polygon2d>> pair = {
+    std::make_shared<Polygon2d>(star(100, 100, 150, 5000)), unioned};
+  BENCHMARK("Clipper difference")
+  {
+    return ClipperUtils::apply(pair, Clipper2Lib::ClipType::Difference);
+  };
+}
@@ -1,7 +1,6 @@
 #include "geometry/linear_extrude.h"
 
 #include <algorithm>
-#include <iterator>
 #include <cassert>
 #include <cmath>
 #include <utility>
@@ -20,6 +19,7 @@
 #include "geometry/PolySetBuilder.h"
 #include "geometry/PolySetUtils.h"
 #include "utils/degree_trig.h"
+#include "utils/parallel.h"
 
 namespace LinearExtrudeInternals {
 
@@ -54,35 +54,32 @@ std::unique_ptr<PolySet> assemblePolySetForManifold(const Polygon2d& polyref,
                                                     PolygonIndices&& indices, int convexity,
                                                     boost::tribool isConvex, int index_offset)
 {
-  auto final_polyset = std::make_unique<PolySet>(3, isConvex);
-  final_polyset->setTriangular(true);
-  final_polyset->setConvexity(convexity);
-  final_polyset->vertices = std::move(vertices);
-  final_polyset->indices = std::move(indices);
-
   // Get valid top and bottom edges (as Indexed Face Sets aka Indices).
   // If top is scaled it doesn't matter: we're only using the edges and not vertices.
   auto ps_topbottom = polyref.tessellate();
   // Manifold tessellating doesn't add vertices (at least in this case? ever? not sure), so the indices
   // remain valid.
+  const auto& endcap = ps_topbottom->indices.get();
+  indices.reserve(indices.size() + 2 * endcap.size());
 
   // Copy indices for the top face, with appropriate offset.
-  for (const auto& p_original : ps_topbottom->indices) {
-    final_polyset->indices.emplace_back();
-    auto& p_offset = final_polyset->indices.back();
-
+  for (const auto& p_original : endcap) {
+    auto& p_offset = indices.emplace_back();
     for (int index : p_original) {
       p_offset.push_back(index + index_offset);
     }
   }
 
-  // Flip vertex ordering for bottom polygon and move it.
-  for (auto& p : ps_topbottom->indices) {
-    std::reverse(p.begin(), p.end());
+  // Copy indices for the bottom face with flipped vertex ordering.
+  for (const auto& p : endcap) {
+    indices.emplace_back(p.rbegin(), p.rend());
   }
-  std::copy(std::make_move_iterator(ps_topbottom->indices.begin()),
-            std::make_move_iterator(ps_topbottom->indices.end()),
-            std::back_inserter(final_polyset->indices));
+
+  auto final_polyset = std::make_unique<PolySet>(3, isConvex);
+  final_polyset->setTriangular(true);
+  final_polyset->setConvexity(convexity);
+  final_polyset->vertices = std::move(vertices);
+  final_polyset->indices = std::move(indices);
 
   // LOG(PolySetUtils::polySetToPolyhedronSource(*final_polyset));
 
@@ -140,15 +137,15 @@ std::unique_ptr<PolySet> assemblePolySetForCGAL(const Polygon2d& polyref,
  * and their corresponding transformed points one step up: (prev_vtx_top, vtx_top).
  * Quads are triangulated across the shorter of the two diagonals, which works well in most cases.
  * However, when diagonals are equal length, decision may flip depending on other factors.
- * @param indices All faces for this slice are added to this.
+ * @param faces The 2 * slice_stride side faces of this slice are written here.
  * @param slice_idx Which slice is currently having faces added **1-indexed** not 0-indexed.
  * @param slice_stride Total count of vertices in all polygons being extruded.
  * @param poly The polygon being extruded.
  * @param rotation_slice_bottom The degrees(?) of rotation for the polygon at the bottom of this slice.
  * @param scale_slice_top The vector of scaling applied to the polygon at the top of this slice.
  */
-void add_slice_indices(PolygonIndices& indices, int slice_idx, int slice_stride, const Polygon2d& poly,
-                       double rotation_slice_bottom, double rotation_slice_top,
+void add_slice_indices(PolygonIndices::iterator faces, int slice_idx, int slice_stride,
+                       const Polygon2d& poly, double rotation_slice_bottom, double rotation_slice_top,
                        const Vector2d& scale_slice_bottom, const Vector2d& scale_slice_top)
 {
   int bottom_offset = (slice_idx - 1) * slice_stride;
@@ -193,27 +190,27 @@ void add_slice_indices(PolygonIndices& indices, int slice_idx, int slice_stride,
       // Split along shortest diagonal,
       // unless at top for a 0-scaled axis (which can create 0 thickness "ears")
       if (splitfirst xor any_zero) {
-        indices.push_back({
+        *faces++ = {
           bottom_offset + idx,
           top_offset + idx,
           bottom_offset + prev_idx,
-        });
-        indices.push_back({
+        };
+        *faces++ = {
           top_offset + prev_idx,
           bottom_offset + prev_idx,
           top_offset + idx,
-        });
+        };
       } else {
-        indices.push_back({
+        *faces++ = {
           bottom_offset + idx,
           top_offset + prev_idx,
           bottom_offset + prev_idx,
-        });
-        indices.push_back({
+        };
+        *faces++ = {
           bottom_offset + idx,
           top_offset + idx,
           top_offset + prev_idx,
-        });
+        };
       }
       prev_vtx_bot = vtx_bot;
       prev_vtx_top = vtx_top;
@@ -321,35 +318,53 @@ void prepareVerticesAndIndices(const Polygon2d& polyref, Vector3d h1, Vector3d h
   for (const auto& o : polyref.outlines()) {
     slice_stride += o.vertices.size();
   }
-  vertices.reserve(slice_stride * (num_slices + 1));
+  assert(vertices.empty() && indices.empty());
+  vertices.resize(slice_stride * (num_slices + 1));
   indices.reserve(slice_stride * (num_slices + 1) * 2);  // sides + endcaps
+  indices.resize(slice_stride * num_slices * 2);
+
+  // Slices are independent and write to their own part of the preallocated arrays, so they are
+  // computed in parallel, in chunks of about the same number of vertices.
+  const unsigned int slices_per_chunk = std::max(4096 / std::max(slice_stride, 1), 1);
+  const unsigned int num_rings = num_slices + 1;
+  std::vector<unsigned int> chunks;
+  for (unsigned int slice_idx = 0; slice_idx < num_rings; slice_idx += slices_per_chunk) {
+    chunks.push_back(slice_idx);
+  }
 
   // Calculate all vertices
   Vector2d full_scale(1 - scale_x, 1 - scale_y);
   double full_rot = -twist;
   auto full_height = (h2 - h1);
-  for (unsigned int slice_idx = 0; slice_idx <= num_slices; slice_idx++) {
-    Eigen::Affine2d trans(Eigen::Scaling(Vector2d(1, 1) - full_scale * slice_idx / num_slices) *
-                          Eigen::Affine2d(rotate_degrees(full_rot * slice_idx / num_slices)));
-
-    for (const auto& o : polyref.outlines()) {
-      for (const auto& v : o.vertices) {
-        auto tmp = trans * v;
-        vertices.emplace_back(Vector3d(tmp[0], tmp[1], 0.0) + h1 + full_height * slice_idx / num_slices);
+  parallelizable_for_each(chunks.begin(), chunks.end(), [&](unsigned int begin) {
+    const unsigned int end = std::min(begin + slices_per_chunk, num_rings);
+    for (unsigned int slice_idx = begin; slice_idx < end; slice_idx++) {
+      Eigen::Affine2d trans(Eigen::Scaling(Vector2d(1, 1) - full_scale * slice_idx / num_slices) *
+                            Eigen::Affine2d(rotate_degrees(full_rot * slice_idx / num_slices)));
+      auto out = vertices.begin() + slice_idx * slice_stride;
+      for (const auto& o : polyref.outlines()) {
+        for (const auto& v : o.vertices) {
+          auto tmp = trans * v;
+          *out++ = Vector3d(tmp[0], tmp[1], 0.0) + h1 + full_height * slice_idx / num_slices;
+        }
       }
     }
-  }
+  });
 
   // Create indices for sides
-  for (unsigned int slice_idx = 1; slice_idx <= num_slices; slice_idx++) {
-    double rot_bot = twist * (slice_idx - 1) / num_slices;
-    double rot_top = twist * slice_idx / num_slices;
-    Vector2d scale_bot(1 - (1 - scale_x) * (slice_idx - 1) / num_slices,
-                       1 - (1 - scale_y) * (slice_idx - 1) / num_slices);
-    Vector2d scale_top(1 - (1 - scale_x) * slice_idx / num_slices,
-                       1 - (1 - scale_y) * slice_idx / num_slices);
-    add_slice_indices(indices, slice_idx, slice_stride, polyref, rot_bot, rot_top, scale_bot, scale_top);
-  }
+  parallelizable_for_each(chunks.begin(), chunks.end(), [&](unsigned int begin) {
+    const unsigned int end = std::min(begin + slices_per_chunk, num_rings);
+    for (unsigned int slice_idx = std::max(begin, 1u); slice_idx < end; slice_idx++) {
+      double rot_bot = twist * (slice_idx - 1) / num_slices;
+      double rot_top = twist * slice_idx / num_slices;
+      Vector2d scale_bot(1 - (1 - scale_x) * (slice_idx - 1) / num_slices,
+                         1 - (1 - scale_y) * (slice_idx - 1) / num_slices);
+      Vector2d scale_top(1 - (1 - scale_x) * slice_idx / num_slices,
+                         1 - (1 - scale_y) * slice_idx / num_slices);
+      add_slice_indices(indices.begin() + (slice_idx - 1) * slice_stride * 2, slice_idx, slice_stride,
+                        polyref, rot_bot, rot_top, scale_bot, scale_top);
+    }
+  });
 }
 
 }  // namespace LinearExtrudeInternals
@@ -411,8 +426,11 @@ std::unique_ptr<Geometry> extrudePolygon(const LinearExtrudeNode& node, const Po
 
 #ifdef ENABLE_MANIFOLD
   if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
-    return assemblePolySetForManifold(polyref, std::move(vertices), std::move(indices), node.convexity,
-                                      isConvex, slice_stride * num_slices);
+    auto ps = assemblePolySetForManifold(polyref, std::move(vertices), std::move(indices),
+                                         node.convexity, isConvex, slice_stride * num_slices);
+    // Every edge is shared by exactly two faces, unless a zero scale collapses the top
+    ps->setManifold(node.scale_x != 0 && node.scale_y != 0);
+    return ps;
   } else
 #endif
     return assemblePolySetForCGAL(polyref, vertices, indices, node.convexity, isConvex, node.scale_x,
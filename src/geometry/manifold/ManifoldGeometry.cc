@@ -3,6 +3,7 @@
 #include "geometry/Geometry.h"
 #include "geometry/linalg.h"
 #include "geometry/Polygon2d.h"
+#include <algorithm>
 #include <map>
 #include <set>
 #include <functional>
@@ -10,6 +11,8 @@
 #include <sstream>
 #include <utility>
 #include <cstdint>
+#include <cstring>
+#include <vector>
 #include <manifold/cross_section.h>
 #include <manifold/manifold.h>
 #include "geometry/PolySet.h"
@@ -18,6 +21,7 @@
 #include "geometry/manifold/manifoldutils.h"
 #include "glview/ColorMap.h"
 #include "glview/RenderSettings.h"
+#include "utils/parallel.h"
 #include <cstddef>
 #include <string>
 #include <memory>
@@ -127,18 +131,39 @@ std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const
   manifold::MeshGL64 mesh = getManifold().GetMeshGL64();
   auto ps = std::make_shared<PolySet>(3);
   ps->setTriangular(true);
-  ps->vertices.reserve(mesh.NumVert());
-  ps->indices.reserve(mesh.NumTri());
   ps->setConvexity(convexity);
   ps->setManifold(true);
 
   // first 3 channels are xyz coordinate
-  for (size_t i = 0; i < mesh.vertProperties.size(); i += mesh.numProp)
-    ps->vertices.emplace_back(mesh.vertProperties[i], mesh.vertProperties[i + 1],
-                              mesh.vertProperties[i + 2]);
+  auto& vertices = ps->vertices.mut();
+  vertices.resize(mesh.NumVert());
+  if (mesh.numProp == 3) {
+    // Vector3d is three packed doubles, the same layout as vertProperties
+    static_assert(sizeof(Vector3d) == 3 * sizeof(double));
+    std::memcpy(vertices.data(), mesh.vertProperties.data(), vertices.size() * sizeof(Vector3d));
+  } else {
+    for (size_t v = 0, i = 0; v < vertices.size(); ++v, i += mesh.numProp) {
+      vertices[v] = {mesh.vertProperties[i], mesh.vertProperties[i + 1], mesh.vertProperties[i + 2]};
+    }
+  }
+
+  const size_t firstTri = mesh.runIndex.empty() ? 0 : mesh.runIndex.front();
+  const size_t numTri = mesh.runIndex.empty() ? 0 : (mesh.runIndex.back() - firstTri) / 3;
+  auto& indices = ps->indices.mut();
+  indices.resize(numTri);
+  constexpr size_t chunkSize = 65536;
+  std::vector<size_t> chunks;
+  for (size_t begin = 0; begin < numTri; begin += chunkSize) chunks.push_back(begin);
+  parallelizable_for_each(chunks.begin(), chunks.end(), [&](size_t begin) {
+    for (size_t t = begin, end = std::min(begin + chunkSize, numTri); t < end; ++t) {
+      const auto *tri = &mesh.triVerts[firstTri + 3 * t];
+      indices[t] = {static_cast<int>(tri[0]), static_cast<int>(tri[1]), static_cast<int>(tri[2])};
+    }
+  });
 
   ps->colors.reserve(originalIDToColor_.size());
-  ps->color_indices.reserve(ps->indices.size());
+  auto& color_indices = ps->color_indices.mut();
+  color_indices.resize(numTri);
 
   auto colorScheme = ColorMap::inst()->findColorScheme(RenderSettings::inst()->colorscheme);
   int32_t faceFrontColorIndex = -1;
@@ -185,22 +210,14 @@ std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const
     return color_index;
   };
 
-  auto start = mesh.runIndex[0];
-  for (int run = 0, numRun = mesh.runIndex.size() - 1; run < numRun; ++run) {
-    const auto id = mesh.runOriginalID[run];
-    const auto end = mesh.runIndex[run + 1];
-    const size_t numTri = (end - start) / 3;
-    if (numTri == 0) {
+  for (size_t run = 0; run + 1 < mesh.runIndex.size(); ++run) {
+    const size_t start = (mesh.runIndex[run] - firstTri) / 3;
+    const size_t end = (mesh.runIndex[run + 1] - firstTri) / 3;
+    if (start == end) {
       continue;
     }
-
-    auto colorIndex = getColorIndex(id);
-    for (size_t i = start; i < end; i += 3) {
-      ps->indices.push_back({static_cast<int>(mesh.triVerts[i]), static_cast<int>(mesh.triVerts[i + 1]),
-                             static_cast<int>(mesh.triVerts[i + 2])});
-      ps->color_indices.push_back(colorIndex);
-    }
-    start = end;
+    std::fill(color_indices.begin() + start, color_indices.begin() + end,
+              getColorIndex(mesh.runOriginalID[run]));
   }
   return ps;
 }
@@ -1,7 +1,9 @@
 // Portions of this file are Copyright 2023 Google LLC, and licensed under GPL2+. See COPYING.
 #include "geometry/manifold/manifoldutils.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <optional>
 #include <vector>
 #include <cassert>
@@ -19,9 +21,11 @@
 #endif
 
 #include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/linalg.h"
 #include "geometry/manifold/ManifoldGeometry.h"
 #include "geometry/PolySetBuilder.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 #include "geometry/PolySetUtils.h"
 #include "geometry/PolySet.h"
@@ -36,51 +40,79 @@ namespace {
 std::shared_ptr<ManifoldGeometry> createManifoldFromTriangularPolySet(const PolySet& ps)
 {
   assert(ps.isTriangular());
+  const size_t numFaces = ps.indices.size();
 
   manifold::MeshGL64 mesh;
 
+  // Vector3d is three packed doubles, the same layout as vertProperties with numProp == 3
+  static_assert(sizeof(Vector3d) == 3 * sizeof(double));
   mesh.numProp = 3;
-  mesh.vertProperties.reserve(ps.vertices.size() * 3);
-  for (const auto& v : ps.vertices) {
-    mesh.vertProperties.push_back(v.x());
-    mesh.vertProperties.push_back(v.y());
-    mesh.vertProperties.push_back(v.z());
-  }
-
-  mesh.triVerts.reserve(ps.indices.size() * 3);
+  mesh.vertProperties.resize(ps.vertices.size() * 3);
+  std::memcpy(mesh.vertProperties.data(), ps.vertices.data(), ps.vertices.size() * sizeof(Vector3d));
 
   std::set<uint32_t> originalIDs;
   std::map<uint32_t, Color4f> originalIDToColor;
 
-  std::map<std::optional<Color4f>, std::vector<size_t>> colorToFaceIndices;
-  for (size_t i = 0, n = ps.indices.size(); i < n; i++) {
-    auto color_index = i < ps.color_indices.size() ? ps.color_indices[i] : -1;
-    std::optional<Color4f> color;
-    if (color_index >= 0) {
-      color = ps.colors[color_index];
-    }
-    colorToFaceIndices[color].push_back(i);
+  // Faces are grouped into one run per distinct color, in color order. Colors are only compared
+  // once per color index, after which faces are placed into their runs by a counting sort.
+  const auto faceColorIndex = [&](size_t i) -> int32_t {
+    return i < ps.color_indices.size() && ps.color_indices[i] >= 0 ? ps.color_indices[i] : -1;
+  };
+  std::vector<bool> usedColorIndices(ps.colors.size() + 1, false);  // shifted by one for -1
+  for (size_t i = 0; i < numFaces; i++) usedColorIndices[faceColorIndex(i) + 1] = true;
+  const auto colorOf = [&](size_t c) {
+    return c == 0 ? std::optional<Color4f>() : std::optional<Color4f>(ps.colors[c - 1]);
+  };
+  std::map<std::optional<Color4f>, size_t> colorToRun;
+  for (size_t c = 0; c < usedColorIndices.size(); ++c) {
+    if (usedColorIndices[c]) colorToRun.emplace(colorOf(c), 0);
+  }
+  size_t numRuns = 0;
+  for (auto& [color, run] : colorToRun) run = numRuns++;
+  std::vector<size_t> colorIndexToRun(usedColorIndices.size(), 0);
+  for (size_t c = 0; c < usedColorIndices.size(); ++c) {
+    if (usedColorIndices[c]) colorIndexToRun[c] = colorToRun[colorOf(c)];
   }
-  auto next_id = manifold::Manifold::ReserveIDs(colorToFaceIndices.size());
-  for (const auto& [color, faceIndices] : colorToFaceIndices) {
+
+  // First face of each run
+  std::vector<size_t> runStart(numRuns + 1, 0);
+  if (numRuns > 1) {
+    for (size_t i = 0; i < numFaces; i++) runStart[colorIndexToRun[faceColorIndex(i) + 1] + 1]++;
+    for (size_t run = 0; run < numRuns; ++run) runStart[run + 1] += runStart[run];
+  } else if (numRuns == 1) {
+    runStart[1] = numFaces;
+  }
+
+  auto next_id = manifold::Manifold::ReserveIDs(numRuns);
+  for (const auto& [color, run] : colorToRun) {
     auto id = next_id++;
     if (color.has_value()) {
       originalIDToColor[id] = color.value();
     }
-
-    mesh.runIndex.push_back(mesh.triVerts.size());
+    mesh.runIndex.push_back(3 * runStart[run]);
     mesh.runOriginalID.push_back(id);
     originalIDs.insert(id);
-
-    for (size_t faceIndex : faceIndices) {
-      auto& face = ps.indices[faceIndex];
-      assert(face.size() == 3);
-      mesh.triVerts.push_back(face[0]);
-      mesh.triVerts.push_back(face[1]);
-      mesh.triVerts.push_back(face[2]);
-    }
   }
-  mesh.runIndex.push_back(mesh.triVerts.size());
+  mesh.runIndex.push_back(3 * numFaces);
+
+  mesh.triVerts.resize(numFaces * 3);
+  const auto copyFace = [&](size_t faceIndex, size_t triIndex) {
+    const auto& face = ps.indices[faceIndex];
+    assert(face.size() == 3);
+    std::copy(face.begin(), face.end(), mesh.triVerts.begin() + 3 * triIndex);
+  };
+  if (numRuns > 1) {
+    std::vector<size_t> next(runStart.begin(), runStart.end() - 1);
+    for (size_t i = 0; i < numFaces; i++) copyFace(i, next[colorIndexToRun[faceColorIndex(i) + 1]]++);
+  } else {
+    // A single run keeps the face order, so faces are copied in parallel
+    constexpr size_t chunkSize = 65536;
+    std::vector<size_t> chunks;
+    for (size_t begin = 0; begin < numFaces; begin += chunkSize) chunks.push_back(begin);
+    parallelizable_for_each(chunks.begin(), chunks.end(), [&](size_t begin) {
+      for (size_t i = begin, end = std::min(begin + chunkSize, numFaces); i < end; i++) copyFace(i, i);
+    });
+  }
 
   auto mani = manifold::Manifold(mesh);
 
@@ -200,6 +232,12 @@ std::shared_ptr<const ManifoldGeometry> createManifoldFromGeometry(
   if (auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
     return mani;
   }
+  if (auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    // Manifold transforms lazily, so the mesh is converted without copying it first
+    auto mani = createManifoldFromPolySet(*instance->getBase());
+    if (mani) mani->transform(instance->getMatrix());
+    return mani;
+  }
   if (auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
     return createManifoldFromPolySet(*ps);
   }
@@ -0,0 +1,81 @@
+#include <catch2/catch_all.hpp>
+#include "geometry/manifold/manifoldutils.h"
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+#include "geometry/linalg.h"
+#include "geometry/manifold/ManifoldGeometry.h"
+#include "geometry/PolySet.h"
+
+namespace {
+
+// A triangulated torus with 2 * rings * segments faces
+std::unique_ptr<PolySet> createTorus(int rings, int segments)
+{
+  auto ps = std::make_unique<PolySet>(3);
+  ps->setTriangular(true);
+  ps->vertices.reserve(static_cast<size_t>(rings) * segments);
+  for (int i = 0; i < rings; ++i) {
+    const double phi = 2 * M_PI * i / rings;
+    for (int j = 0; j < segments; ++j) {
+      const double theta = 2 * M_PI * j / segments;
+      const double r = 10 + 3 * std::cos(theta);
+      ps->vertices.emplace_back(r * std::cos(phi), r * std::sin(phi), 3 * std::sin(theta));
+    }
+  }
+  ps->indices.reserve(2 * static_cast<size_t>(rings) * segments);
+  for (int i = 0; i < rings; ++i) {
+    for (int j = 0; j < segments; ++j) {
+      const int a = i * segments + j;
+      const int b = ((i + 1) % rings) * segments + j;
+      const int c = ((i + 1) % rings) * segments + (j + 1) % segments;
+      const int d = i * segments + (j + 1) % segments;
+      ps->indices.push_back({a, b, c});
+      ps->indices.push_back({a, c, d});
+    }
+  }
+  return ps;
+}
+
+}  // namespace
+
+TEST_CASE("PolySet to Manifold round trip keeps the mesh", "[manifold]")
+{
+  const auto ps = createTorus(32, 16);
+  const auto mani = ManifoldUtils::createManifoldFromPolySet(*ps);
+  REQUIRE(mani->getManifold().Status() == manifold::Manifold::Error::NoError);
+  const auto back = mani->toPolySet();
+  CHECK(back->vertices.size() == ps->vertices.size());
+  CHECK(back->indices.size() == ps->indices.size());
+  CHECK(back->color_indices.size() == back->indices.size());
+}
+
+TEST_CASE("PolySet <-> Manifold conversion throughput", "[.][benchmark][manifold]")
+{
+  const auto ps = createTorus(1000, 1000);
+  BENCHMARK("PolySet -> Manifold of a 2M triangle torus")
+  {
+    return ManifoldUtils::createManifoldFromPolySet(*ps);
+  };
+
+  const auto mani = ManifoldUtils::createManifoldFromPolySet(*ps);
+  REQUIRE(mani->getManifold().Status() == manifold::Manifold::Error::NoError);
+  BENCHMARK("Manifold -> PolySet of a 2M triangle torus") { return mani->toPolySet(); };
+}
+
+TEST_CASE("Manifold booleans", "[.][benchmark][manifold]")
+{
+  const auto a = ManifoldUtils::createManifoldFromPolySet(*createTorus(300, 200));
+  auto b = std::make_shared<ManifoldGeometry>(*a);
+  Transform3d shift = Transform3d::Identity();
+  shift.translate(Vector3d(5, 3, 1));
+  shift.rotate(Eigen::AngleAxisd(M_PI / 3, Vector3d::UnitX()));
+  b->transform(shift);
+
+  // Manifold evaluates lazily, counting the facets forces the result
+  BENCHMARK("Manifold union of 120k triangle tori") { return (*a + *b).numFacets(); };
+  BENCHMARK("Manifold difference of 120k triangle tori") { return (*a - *b).numFacets(); };
+  BENCHMARK("Manifold intersection of 120k triangle tori") { return (*a * *b).numFacets(); };
+}
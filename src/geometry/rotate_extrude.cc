@@ -4,7 +4,6 @@
 #include <cassert>
 #include <cstddef>
 #include <cmath>
-#include <iterator>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -18,8 +17,10 @@
 #include "geometry/Polygon2d.h"
 #include "geometry/linalg.h"
 #include "geometry/PolySet.h"
+#include "glview/RenderSettings.h"
 #include "utils/calc.h"
 #include "utils/degree_trig.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 static std::unique_ptr<PolySet> assemblePolySetForManifold(const Polygon2d& polyref,
@@ -28,34 +29,32 @@ static std::unique_ptr<PolySet> assemblePolySetForManifold(const Polygon2d& poly
                                                            int convexity, int index_offset,
                                                            bool flip_faces)
 {
-  auto final_polyset = std::make_unique<PolySet>(3, false);
-  final_polyset->setTriangular(true);
-  final_polyset->setConvexity(convexity);
-  final_polyset->vertices = std::move(vertices);
-  final_polyset->indices = std::move(indices);
-
   if (!closed) {
     // Create top and bottom face.
     auto ps_bottom = polyref.tessellate();  // bottom
+    const auto& endcap = ps_bottom->indices.get();
+    indices.reserve(indices.size() + 2 * endcap.size());
     // Flip vertex ordering for bottom polygon unless flip_faces is true
-    if (!flip_faces) {
-      for (auto& p : ps_bottom->indices) {
-        std::reverse(p.begin(), p.end());
-      }
+    for (const auto& p : endcap) {
+      if (flip_faces) indices.emplace_back(p.begin(), p.end());
+      else indices.emplace_back(p.rbegin(), p.rend());
     }
-    std::copy(ps_bottom->indices.begin(), ps_bottom->indices.end(),
-              std::back_inserter(final_polyset->indices));
-
-    for (auto& p : ps_bottom->indices) {
-      std::reverse(p.begin(), p.end());
-      for (auto& i : p) {
+    // The top polygon has the opposite vertex ordering
+    for (const auto& p : endcap) {
+      auto& p_offset = indices.emplace_back(p.begin(), p.end());
+      if (flip_faces) std::reverse(p_offset.begin(), p_offset.end());
+      for (auto& i : p_offset) {
         i += index_offset;
       }
     }
-    std::copy(ps_bottom->indices.begin(), ps_bottom->indices.end(),
-              std::back_inserter(final_polyset->indices));
   }
 
+  auto final_polyset = std::make_unique<PolySet>(3, false);
+  final_polyset->setTriangular(true);
+  final_polyset->setConvexity(convexity);
+  final_polyset->vertices = std::move(vertices);
+  final_polyset->indices = std::move(indices);
+
   //  LOG(PolySetUtils::polySetToPolyhedronSource(*final_polyset));
 
   return final_polyset;
@@ -84,10 +83,12 @@ std::unique_ptr<Geometry> rotatePolygon(const RotateExtrudeNode& node, const Pol
 
   double min_x = 0;
   double max_x = 0;
+  bool on_axis = false;
   for (const auto& o : poly.outlines()) {
     for (const auto& v : o.vertices) {
       min_x = fmin(min_x, v[0]);
       max_x = fmax(max_x, v[0]);
+      on_axis |= v[0] == 0;
     }
   }
 
@@ -115,63 +116,87 @@ std::unique_ptr<Geometry> rotatePolygon(const RotateExtrudeNode& node, const Pol
     slice_stride += o.vertices.size();
   }
   const int num_vertices = slice_stride * num_rings;
-  std::vector<Vector3d> vertices;
-  vertices.reserve(num_vertices);
+  std::vector<Vector3d> vertices(num_vertices);
   PolygonIndices indices;
   indices.reserve(slice_stride * num_rings * 2);  // sides + endcaps if needed
+  indices.resize(slice_stride * num_sections * 2);
+
+  // Rings are independent and write to their own part of the preallocated arrays, so they are
+  // computed in parallel, in chunks of about the same number of vertices.
+  const unsigned int rings_per_chunk = std::max(4096 / std::max<size_t>(slice_stride, 1), size_t{1});
+  std::vector<unsigned int> chunks;
+  for (unsigned int j = 0; j < num_rings; j += rings_per_chunk) {
+    chunks.push_back(j);
+  }
 
   // Calculate all vertices
-  for (unsigned int j = 0; j < num_rings; ++j) {
-    for (const auto& outline : poly.outlines()) {
-      const double angle = node.start + j * node.angle / num_sections;  // start on the X axis
-      for (const auto& v : outline.vertices) {
-        vertices.emplace_back(v[0] * cos_degrees(angle), v[0] * sin_degrees(angle), v[1]);
+  parallelizable_for_each(chunks.begin(), chunks.end(), [&](unsigned int begin) {
+    const unsigned int end = std::min<size_t>(begin + rings_per_chunk, num_rings);
+    for (unsigned int j = begin; j < end; ++j) {
+      auto out = vertices.begin() + j * slice_stride;
+      for (const auto& outline : poly.outlines()) {
+        const double angle = node.start + j * node.angle / num_sections;  // start on the X axis
+        for (const auto& v : outline.vertices) {
+          *out++ = Vector3d(v[0] * cos_degrees(angle), v[0] * sin_degrees(angle), v[1]);
+        }
       }
     }
-  }
+  });
 
   // Calculate all indices
-  for (unsigned int slice_idx = 1; slice_idx <= num_sections; slice_idx++) {
-    const int prev_slice = (slice_idx - 1) * slice_stride;
-    const int curr_slice = slice_idx * slice_stride;
-    int curr_outline = 0;
-    for (const auto& outline : poly.outlines()) {
-      assert(outline.vertices.size() > 2);
-      for (size_t i = 1; i <= outline.vertices.size(); ++i) {
-        const int curr_idx = curr_outline + (i % outline.vertices.size());
-        const int prev_idx = curr_outline + i - 1;
-        if (flip_faces) {
-          indices.push_back({
-            (prev_slice + prev_idx) % num_vertices,
-            (curr_slice + curr_idx) % num_vertices,
-            (prev_slice + curr_idx) % num_vertices,
-          });
-          indices.push_back({
-            (curr_slice + curr_idx) % num_vertices,
-            (prev_slice + prev_idx) % num_vertices,
-            (curr_slice + prev_idx) % num_vertices,
-          });
-        } else {
-          indices.push_back({
-            (prev_slice + curr_idx) % num_vertices,
-            (curr_slice + curr_idx) % num_vertices,
-            (prev_slice + prev_idx) % num_vertices,
-          });
-          indices.push_back({
-            (curr_slice + prev_idx) % num_vertices,
-            (prev_slice + prev_idx) % num_vertices,
-            (curr_slice + curr_idx) % num_vertices,
-          });
+  parallelizable_for_each(chunks.begin(), chunks.end(), [&](unsigned int begin) {
+    const unsigned int end = std::min<unsigned int>(begin + rings_per_chunk, num_sections);
+    for (unsigned int slice_idx = begin + 1; slice_idx <= end; slice_idx++) {
+      auto faces = indices.begin() + (slice_idx - 1) * slice_stride * 2;
+      const int prev_slice = (slice_idx - 1) * slice_stride;
+      const int curr_slice = slice_idx * slice_stride;
+      int curr_outline = 0;
+      for (const auto& outline : poly.outlines()) {
+        assert(outline.vertices.size() > 2);
+        for (size_t i = 1; i <= outline.vertices.size(); ++i) {
+          const int curr_idx = curr_outline + (i % outline.vertices.size());
+          const int prev_idx = curr_outline + i - 1;
+          if (flip_faces) {
+            *faces++ = {
+              (prev_slice + prev_idx) % num_vertices,
+              (curr_slice + curr_idx) % num_vertices,
+              (prev_slice + curr_idx) % num_vertices,
+            };
+            *faces++ = {
+              (curr_slice + curr_idx) % num_vertices,
+              (prev_slice + prev_idx) % num_vertices,
+              (curr_slice + prev_idx) % num_vertices,
+            };
+          } else {
+            *faces++ = {
+              (prev_slice + curr_idx) % num_vertices,
+              (curr_slice + curr_idx) % num_vertices,
+              (prev_slice + prev_idx) % num_vertices,
+            };
+            *faces++ = {
+              (curr_slice + prev_idx) % num_vertices,
+              (prev_slice + prev_idx) % num_vertices,
+              (curr_slice + curr_idx) % num_vertices,
+            };
+          }
         }
+        curr_outline += outline.vertices.size();
       }
-      curr_outline += outline.vertices.size();
     }
-  }
+  });
 
   // TODO(kintel): Without Manifold, we don't have such tessellator available which guarantees to not
   // modify vertices, so we technically may end up with broken end caps if we build OpenSCAD without
   // ENABLE_MANIFOLD. Should be fixed, but it's low priority and it's not trivial to come up with a test
   // case for this.
-  return assemblePolySetForManifold(poly, vertices, indices, closed, node.convexity,
-                                    slice_stride * num_sections, flip_faces);
+  auto ps = assemblePolySetForManifold(poly, vertices, indices, closed, node.convexity,
+                                       slice_stride * num_sections, flip_faces);
+#ifdef ENABLE_MANIFOLD
+  // Every edge is shared by exactly two faces, unless a vertex on the Y axis collapses a ring.
+  // Only claimed for Manifold, as the CGAL backend skips validation of manifold PolySets.
+  if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
+    ps->setManifold(!on_axis);
+  }
+#endif
+  return ps;
 }
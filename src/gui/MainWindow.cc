@@ -28,6 +28,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstring>
 #include <deque>
 #include <exception>
@@ -138,6 +139,7 @@
 #include "io/dxfdim.h"
 #include "io/export.h"
 #include "io/fileutils.h"
+#include "io/ImportCache.h"
 #include "openscad.h"
 #include "platform/PlatformUtils.h"
 #include "utils/exceptions.h"
@@ -617,7 +619,7 @@ void MainWindow::showProgress()
   updateStatusBar(qobject_cast<ProgressWidget *>(sender()));
 }
 
-void MainWindow::report_func(const std::shared_ptr<const AbstractNode>&, void *vp, int mark)
+void MainWindow::report_func(const std::shared_ptr<const AbstractNode>&, void *vp, int /*mark*/)
 {
   // limit to progress bar update calls to 5 per second
   static const qint64 MIN_TIMEOUT = 200;
@@ -625,13 +627,25 @@ void MainWindow::report_func(const std::shared_ptr<const AbstractNode>&, void *v
     progressThrottle->start();
 
     auto thisp = static_cast<MainWindow *>(vp);
-    auto v = static_cast<int>((mark * 1000.0) / progress_report_count);
+    // Weighted by the estimated cost of nodes, as a few nodes may take most of the time
+    const auto estimate = progress_estimate();
+    auto v = static_cast<int>(estimate.fraction * 1000.0);
     auto permille = v < 1000 ? v : 999;
+    bool changed = false;
     if (permille > thisp->progresswidget->value()) {
       QMetaObject::invokeMethod(thisp->progresswidget, "setValue", Qt::QueuedConnection,
                                 Q_ARG(int, permille));
-      QApplication::processEvents();
+      changed = true;
     }
+    // Estimates are unsteady early on
+    const int remaining = estimate.elapsed >= 2 ? static_cast<int>(std::lround(estimate.remaining)) : -1;
+    if (remaining != thisp->progressRemaining) {
+      thisp->progressRemaining = remaining;
+      QMetaObject::invokeMethod(thisp->progresswidget, "setRemaining", Qt::QueuedConnection,
+                                Q_ARG(int, remaining));
+      changed = true;
+    }
+    if (changed) QApplication::processEvents();
 
     // FIXME: Check if cancel was requested by e.g. Application quit
     if (thisp->progresswidget->wasCanceled()) throw ProgressCancelException();
@@ -969,6 +983,7 @@ void MainWindow::compileCSG()
     CSGTreeEvaluator csgrenderer(this->tree, &geomevaluator);
 #endif
 
+    this->progressRemaining = -1;
     if (!isClosing) progress_report_prep(this->rootNode, report_func, this);
     else return;
     try {
@@ -1916,6 +1931,7 @@ void MainWindow::cgalRender()
   this->progresswidget = new ProgressWidget(this);
   connect(this->progresswidget, &ProgressWidget::requestShow, this, &MainWindow::showProgress);
 
+  this->progressRemaining = -1;
   if (!isClosing) progress_report_prep(this->rootNode, report_func, this);
   else return;
 
@@ -2568,6 +2584,7 @@ void MainWindow::on_designActionFlushCaches_triggered()
 {
   GeometryCache::instance()->clear();
   CGALCache::instance()->clear();
+  ImportCache::instance()->clear();
   dxf_dim_cache.clear();
   dxf_cross_cache.clear();
   SourceFileCache::instance()->clear();
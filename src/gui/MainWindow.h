@@ -443,6 +443,8 @@ private:
   bool procevents{false};
   QTemporaryFile *tempFile{nullptr};
   ProgressWidget *progresswidget{nullptr};
+  // Seconds left last sent to progresswidget, only used by the thread reporting progress
+  int progressRemaining{-1};
   CGALWorker *cgalworker;
   QMutex consolemutex;
   EditorInterface *renderedEditor;  // stores pointer to editor which has been most recently rendered
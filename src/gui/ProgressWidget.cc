@@ -50,3 +50,19 @@ int ProgressWidget::value() const
 {
   return this->progressBar->value();
 }
+
+/*!
+   Shows the estimated seconds left in the progress bar, or the progress alone if
+   seconds is negative
+ */
+void ProgressWidget::setRemaining(int seconds)
+{
+  if (seconds < 0) {
+    this->progressBar->setFormat("%v / %m");
+  } else if (seconds < 60) {
+    this->progressBar->setFormat(QString(_("%p% (%1 s left)")).arg(seconds));
+  } else {
+    this->progressBar->setFormat(
+      QString(_("%p% (%1:%2 left)")).arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0')));
+  }
+}
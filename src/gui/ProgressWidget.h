@@ -19,6 +19,7 @@ public slots:
   void setRange(int minimum, int maximum);
   void setValue(int progress);
   int value() const;
+  void setRemaining(int seconds);
   void cancel();
 
 private slots:
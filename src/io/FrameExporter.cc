@@ -0,0 +1,131 @@
+#include "io/FrameExporter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
+#include "geometry/PolySet.h"
+#include "io/export.h"
+#include "utils/printutils.h"
+#ifdef ENABLE_CGAL
+#include "geometry/cgal/CGALNefGeometry.h"
+#endif
+
+namespace {
+
+// A copy of geom for writing on another thread. PolySets compute their bounding box
+// and convexity lazily, so geometry still used for rendering, e.g. from the caches,
+// must not be read by both threads. Copying a PolySet shares its mesh until modified.
+std::shared_ptr<const Geometry> detach(const std::shared_ptr<const Geometry>& geom)
+{
+  if (const auto *list = dynamic_cast<const GeometryList *>(geom.get())) {
+    Geometry::Geometries children;
+    for (const auto& [node, child] : list->getChildren()) {
+      children.emplace_back(node, child ? detach(child) : nullptr);
+    }
+    auto copy = std::make_shared<GeometryList>(std::move(children));
+    copy->setConvexity(list->getConvexity());
+    return copy;
+  }
+  if (dynamic_cast<const PolySet *>(geom.get()) || dynamic_cast<const InstancedGeometry *>(geom.get())) {
+    return geom->copy();
+  }
+  return geom;
+}
+
+}  // namespace
+
+FrameExporter::FrameExporter()
+  : max_pending(getenv("OPENSCAD_NO_PARALLEL") ? 0 : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+FrameExporter::~FrameExporter()
+{
+  for (auto& job : this->pending) job.wait();
+}
+
+bool FrameExporter::canExportInBackground(const Geometry& geom, FileFormat format)
+{
+  switch (format) {
+  case FileFormat::ASCII_STL:
+  case FileFormat::BINARY_STL:
+  case FileFormat::OBJ:
+  case FileFormat::OFF:
+  case FileFormat::WRL:
+  case FileFormat::AMF:
+  case FileFormat::_3MF:
+  case FileFormat::DXF:
+  case FileFormat::SVG:
+  case FileFormat::PDF:
+  case FileFormat::POV:  break;
+  default:               return false;
+  }
+  if (const auto *list = dynamic_cast<const GeometryList *>(&geom)) {
+    const auto& children = list->getChildren();
+    return std::all_of(children.begin(), children.end(), [format](const auto& item) {
+      return !item.second || canExportInBackground(*item.second, format);
+    });
+  }
+#ifdef ENABLE_CGAL
+  // Nef polyhedra share reference counted, non-atomic handles with copies still used for rendering
+  if (dynamic_cast<const CGALNefGeometry *>(&geom)) return false;
+#endif
+  return true;
+}
+
+bool FrameExporter::write(const std::shared_ptr<const Geometry>& geom, const std::string& filename,
+                          const ExportInfo& exportInfo)
+{
+  bool ok = true;
+  if (this->max_pending == 0 || !canExportInBackground(*geom, exportInfo.format)) {
+    // Write earlier frames first, to keep messages in order
+    ok = finish();
+    return exportFileByName(geom, filename, exportInfo) && ok;
+  }
+
+  while (this->pending.size() >= this->max_pending) ok = collect() && ok;
+  try {
+    auto frame = detach(geom);
+    this->pending.push_back(std::async(std::launch::async, [frame, filename, exportInfo]() {
+      Job job;
+      MessageCapture capture;
+      try {
+        job.ok = exportFileByName(frame, filename, exportInfo);
+      } catch (...) {
+        job.error = std::current_exception();
+      }
+      job.messages = capture.release();
+      return job;
+    }));
+  } catch (const std::system_error&) {
+    // No threads available (e.g. WASM builds)
+    this->max_pending = 0;
+    return exportFileByName(geom, filename, exportInfo) && ok;
+  }
+  return ok;
+}
+
+bool FrameExporter::finish()
+{
+  bool ok = true;
+  while (!this->pending.empty()) ok = collect() && ok;
+  return ok;
+}
+
+bool FrameExporter::collect()
+{
+  const Job job = this->pending.front().get();
+  this->pending.pop_front();
+  MessageCapture::replay(job.messages);
+  if (job.error) std::rethrow_exception(job.error);
+  return job.ok;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "geometry/Geometry.h"
+#include "io/export.h"
+#include "utils/printutils.h"
+
+/*!
+   Writes the files of animation frames or parameter set variants on background
+   threads, so the next frames are rendered while earlier ones are written.
+
+   At most a fixed number of frames are written at a time; write() waits for the
+   oldest one beforehand, which also bounds the geometry kept alive. Messages printed
+   while writing a frame are replayed on the calling thread once it is done, so output
+   stays in frame order. Frames are written from copies of PolySets, whose lazily
+   computed bounding boxes and convexity must not be shared with rendering.
+
+   Only writing is concurrent. Frames are still evaluated and rendered one after
+   another, see the animation loop in openscad.cc.
+ */
+class FrameExporter
+{
+public:
+  FrameExporter();
+  // Waits for frames still being written
+  ~FrameExporter();
+
+  // Writes geom to filename like exportFileByName(), on a background thread if the
+  // format and geometry allow. Returns false if writing failed, which for frames
+  // written in the background is only known by a later call or finish().
+  bool write(const std::shared_ptr<const Geometry>& geom, const std::string& filename,
+             const ExportInfo& exportInfo);
+  // Waits until all frames are written. Returns false if any failed.
+  bool finish();
+
+private:
+  struct Job {
+    bool ok = false;
+    std::vector<std::pair<Message, bool>> messages;
+    std::exception_ptr error;
+  };
+
+  static bool canExportInBackground(const Geometry& geom, FileFormat format);
+  // Waits for the oldest frame and replays its messages
+  bool collect();
+
+  size_t max_pending;
+  std::deque<std::future<Job>> pending;
+};
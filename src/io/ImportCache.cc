@@ -0,0 +1,394 @@
+#include "io/ImportCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "core/ImportNode.h"
+#include "core/StatCache.h"
+#include "geometry/Geometry.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+#include "utils/printutils.h"
+
+namespace fs = std::filesystem;
+
+ImportCache *ImportCache::inst = nullptr;
+
+namespace {
+
+// Bump whenever the on-disk layout changes
+constexpr uint32_t PERSISTENT_MAGIC = 0x4f534943;  // "OSIC"
+constexpr uint32_t PERSISTENT_VERSION = 1;
+constexpr uint8_t PERSISTENT_POLYSET = 1;
+constexpr uint8_t PERSISTENT_POLYGON2D = 2;
+
+// Bound on the keys remembered for the persistent cache, see ImportCache::persistentKeys
+constexpr size_t MAX_PERSISTENT_KEYS = 4096;
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+uint64_t hash_bytes(uint64_t h, const char *data, size_t len)
+{
+  for (size_t i = 0; i < len; ++i) {
+    h ^= static_cast<unsigned char>(data[i]);
+    h *= FNV_PRIME;
+  }
+  return h;
+}
+
+// Hashes the file content. Returns false if the file can't be read.
+bool hash_file(const std::string& path, uint64_t& hash)
+{
+  std::ifstream f(path, std::ios::binary);
+  if (!f) return false;
+  std::vector<char> buf(1 << 20);
+  uint64_t h = FNV_OFFSET;
+  while (f) {
+    f.read(buf.data(), buf.size());
+    h = hash_bytes(h, buf.data(), f.gcount());
+  }
+  if (f.bad()) return false;
+  hash = h;
+  return true;
+}
+
+std::string to_hex(uint64_t v)
+{
+  std::ostringstream s;
+  s << std::hex << std::setw(16) << std::setfill('0') << v;
+  return s.str();
+}
+
+template <typename T>
+void write_pod(std::ostream& out, const T& v)
+{
+  out.write(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::istream& in, T& v)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(&v), sizeof(T)));
+}
+
+void write_string(std::ostream& out, const std::string& s)
+{
+  write_pod(out, static_cast<uint64_t>(s.size()));
+  out.write(s.data(), s.size());
+}
+
+// Reads the number of following elements of at least elementSize bytes each, rejecting
+// counts which don't fit into the rest of the entry, so corrupt entries can't make us
+// allocate huge arrays
+bool read_count(std::istream& in, std::streamoff end, uint64_t elementSize, uint64_t& count)
+{
+  if (!read_pod(in, count)) return false;
+  const std::streamoff pos = in.tellg();
+  return pos >= 0 && pos <= end && count <= static_cast<uint64_t>(end - pos) / elementSize;
+}
+
+bool read_string(std::istream& in, std::streamoff end, std::string& s)
+{
+  uint64_t size;
+  if (!read_count(in, end, 1, size)) return false;
+  s.resize(size);
+  return static_cast<bool>(in.read(s.data(), size));
+}
+
+void write_polyset(std::ostream& out, const PolySet& ps)
+{
+  write_pod(out, PERSISTENT_POLYSET);
+  write_pod(out, static_cast<uint32_t>(ps.getDimension()));
+  write_pod(out, static_cast<int32_t>(ps.getConvexity()));
+  write_pod(out, static_cast<uint8_t>(ps.isTriangular()));
+  write_pod(out, static_cast<uint8_t>(ps.isManifold()));
+
+  write_pod(out, static_cast<uint64_t>(ps.vertices.size()));
+  for (const auto& v : ps.vertices) {
+    write_pod(out, v[0]);
+    write_pod(out, v[1]);
+    write_pod(out, v[2]);
+  }
+  write_pod(out, static_cast<uint64_t>(ps.indices.size()));
+  for (const auto& face : ps.indices) {
+    write_pod(out, static_cast<uint32_t>(face.size()));
+    for (const int idx : face) write_pod(out, static_cast<int32_t>(idx));
+  }
+  write_pod(out, static_cast<uint64_t>(ps.color_indices.size()));
+  for (const auto idx : ps.color_indices) write_pod(out, idx);
+  write_pod(out, static_cast<uint64_t>(ps.colors.size()));
+  for (const auto& c : ps.colors) {
+    write_pod(out, c.r());
+    write_pod(out, c.g());
+    write_pod(out, c.b());
+    write_pod(out, c.a());
+  }
+}
+
+std::unique_ptr<PolySet> read_polyset(std::istream& in, std::streamoff end)
+{
+  uint32_t dim;
+  int32_t convexity;
+  uint8_t triangular, manifold;
+  if (!read_pod(in, dim) || !read_pod(in, convexity) || !read_pod(in, triangular) ||
+      !read_pod(in, manifold)) {
+    return nullptr;
+  }
+  if (dim != 2 && dim != 3) return nullptr;
+  auto ps = std::make_unique<PolySet>(dim);
+  ps->setConvexity(convexity);
+  ps->setTriangular(triangular);
+  ps->setManifold(manifold);
+
+  uint64_t count;
+  if (!read_count(in, end, 3 * sizeof(double), count)) return nullptr;
+  std::vector<Vector3d> vertices;
+  vertices.reserve(count);
+  for (uint64_t i = 0; i < count; ++i) {
+    double x, y, z;
+    if (!read_pod(in, x) || !read_pod(in, y) || !read_pod(in, z)) return nullptr;
+    vertices.emplace_back(x, y, z);
+  }
+  if (!read_count(in, end, sizeof(uint32_t), count)) return nullptr;
+  PolygonIndices indices;
+  indices.reserve(count);
+  for (uint64_t i = 0; i < count; ++i) {
+    uint32_t size;
+    if (!read_pod(in, size)) return nullptr;
+    // Not reserved, as the size isn't checked; faces are mostly small enough to be stored inline
+    auto& face = indices.emplace_back();
+    for (uint32_t j = 0; j < size; ++j) {
+      int32_t idx;
+      if (!read_pod(in, idx) || idx < 0 || static_cast<size_t>(idx) >= vertices.size()) {
+        return nullptr;
+      }
+      face.push_back(idx);
+    }
+  }
+  if (!read_count(in, end, sizeof(int32_t), count)) return nullptr;
+  std::vector<int32_t> color_indices(count);
+  for (auto& idx : color_indices) {
+    if (!read_pod(in, idx)) return nullptr;
+  }
+  if (!read_count(in, end, 4 * sizeof(float), count)) return nullptr;
+  std::vector<Color4f> colors;
+  colors.reserve(count);
+  for (uint64_t i = 0; i < count; ++i) {
+    float r, g, b, a;
+    if (!read_pod(in, r) || !read_pod(in, g) || !read_pod(in, b) || !read_pod(in, a)) return nullptr;
+    colors.emplace_back(r, g, b, a);
+  }
+  ps->vertices = std::move(vertices);
+  ps->indices = std::move(indices);
+  ps->color_indices = std::move(color_indices);
+  ps->colors = std::move(colors);
+  return ps;
+}
+
+void write_polygon2d(std::ostream& out, const Polygon2d& poly)
+{
+  write_pod(out, PERSISTENT_POLYGON2D);
+  write_pod(out, static_cast<int32_t>(poly.getConvexity()));
+  write_pod(out, static_cast<uint8_t>(poly.isSanitized()));
+  write_pod(out, static_cast<uint64_t>(poly.outlines().size()));
+  for (const auto& o : poly.outlines()) {
+    write_pod(out, static_cast<uint8_t>(o.positive));
+    write_pod(out, static_cast<uint64_t>(o.vertices.size()));
+    for (const auto& v : o.vertices) {
+      write_pod(out, v[0]);
+      write_pod(out, v[1]);
+    }
+  }
+}
+
+std::unique_ptr<Polygon2d> read_polygon2d(std::istream& in, std::streamoff end)
+{
+  int32_t convexity;
+  uint8_t sanitized;
+  uint64_t count;
+  if (!read_pod(in, convexity) || !read_pod(in, sanitized) ||
+      !read_count(in, end, sizeof(uint8_t) + sizeof(uint64_t), count)) {
+    return nullptr;
+  }
+  auto poly = std::make_unique<Polygon2d>();
+  poly->setConvexity(convexity);
+  for (uint64_t i = 0; i < count; ++i) {
+    Outline2d o;
+    uint8_t positive;
+    uint64_t size;
+    if (!read_pod(in, positive) || !read_count(in, end, 2 * sizeof(double), size)) return nullptr;
+    o.positive = positive;
+    o.vertices.reserve(size);
+    for (uint64_t j = 0; j < size; ++j) {
+      double x, y;
+      if (!read_pod(in, x) || !read_pod(in, y)) return nullptr;
+      o.vertices.emplace_back(x, y);
+    }
+    poly->addOutline(std::move(o));
+  }
+  poly->setSanitized(sanitized);
+  return poly;
+}
+
+}  // namespace
+
+std::string ImportCache::getKey(const ImportNode& node, bool allowHashing)
+{
+  const std::string filename = node.filename;
+  if (filename.empty()) return "";
+
+  std::error_code ec;
+  auto canonical = fs::weakly_canonical(fs::u8path(filename), ec);
+  const std::string path = ec ? filename : canonical.generic_u8string();
+
+  struct stat st;
+  if (StatCache::stat(path, st) != 0) return "";
+
+  // Rehash only if the file changed since we last looked at it
+  auto it = this->hashes.find(path);
+  if (it == this->hashes.end() || it->second.size != static_cast<uintmax_t>(st.st_size) ||
+      it->second.mtime != st.st_mtime) {
+    uint64_t hash;
+    if (!allowHashing || !hash_file(path, hash)) return "";
+    const file_hash fh{static_cast<uintmax_t>(st.st_size), st.st_mtime, hash};
+    it = this->hashes.insert_or_assign(path, fh).first;
+  }
+
+  // Everything that influences createGeometry(), apart from the file itself
+  std::ostringstream params;
+  params << static_cast<int>(node.type);
+  if (node.id) params << ", id = " << QuotedString(node.id.get());
+  if (node.layer) params << ", layer = " << QuotedString(node.layer.get());
+  params << std::setprecision(17) << ", origin = [" << node.origin_x << ", " << node.origin_y
+         << "], dpi = " << node.dpi << ", scale = " << node.scale
+         << ", center = " << (node.center ? "true" : "false") << ", convexity = " << node.convexity
+         << ", " << node.discretizer;
+
+  const std::string contentKey = to_hex(it->second.hash) + ":" + params.str();
+  std::ostringstream key;
+  key << path << ":" << st.st_size << ":" << st.st_mtime << ":" << contentKey;
+  if (this->persistentKeys.size() >= MAX_PERSISTENT_KEYS) this->persistentKeys.clear();
+  this->persistentKeys[key.str()] = contentKey;
+  return key.str();
+}
+
+std::shared_ptr<const Geometry> ImportCache::get(const std::string& key)
+{
+  if (const auto entry = this->cache[key]) return entry->geom;
+  if (this->persistentPath.empty()) return nullptr;
+
+  const auto pkey = persistentKey(key);
+  if (pkey.empty()) return nullptr;
+  std::shared_ptr<const Geometry> geom = load(pkey);
+  if (geom) {
+    this->cache.insert(key, new cache_entry(geom, pkey), geom->memsize());
+  }
+  return geom;
+}
+
+bool ImportCache::insert(const std::string& key, const std::shared_ptr<const Geometry>& geom)
+{
+  const auto pkey = persistentKey(key);
+  const auto inserted = this->cache.insert(key, new cache_entry(geom, pkey), geom ? geom->memsize() : 0);
+  if (geom && !this->persistentPath.empty() && !pkey.empty()) store(pkey, *geom);
+  return inserted;
+}
+
+size_t ImportCache::maxSizeMB() const
+{
+  return this->cache.maxCost() / (1024ul * 1024ul);
+}
+
+void ImportCache::setMaxSizeMB(size_t limit)
+{
+  this->cache.setMaxCost(limit * 1024ul * 1024ul);
+}
+
+void ImportCache::clear()
+{
+  this->cache.clear();
+  this->hashes.clear();
+  this->persistentKeys.clear();
+}
+
+void ImportCache::print()
+{
+  LOG("Imports in cache: %1$d", this->cache.size());
+  LOG("Import cache size in bytes: %1$d", this->cache.totalCost());
+}
+
+std::string ImportCache::persistentKey(const std::string& key) const
+{
+  const auto it = this->persistentKeys.find(key);
+  return it == this->persistentKeys.end() ? "" : it->second;
+}
+
+std::shared_ptr<const Geometry> ImportCache::load(const std::string& persistentKey) const
+{
+  const auto file = fs::u8path(this->persistentPath) /
+                    (to_hex(hash_bytes(FNV_OFFSET, persistentKey.data(), persistentKey.size())) + ".geom");
+  std::ifstream in(file, std::ios::binary | std::ios::ate);
+  if (!in) return nullptr;
+  const std::streamoff end = in.tellg();
+  in.seekg(0);
+
+  uint32_t magic, version;
+  std::string storedKey;
+  uint8_t type;
+  if (!read_pod(in, magic) || magic != PERSISTENT_MAGIC || !read_pod(in, version) ||
+      version != PERSISTENT_VERSION || !read_string(in, end, storedKey) || storedKey != persistentKey ||
+      !read_pod(in, type)) {
+    return nullptr;
+  }
+  switch (type) {
+  case PERSISTENT_POLYSET:   return read_polyset(in, end);
+  case PERSISTENT_POLYGON2D: return read_polygon2d(in, end);
+  default:                   return nullptr;
+  }
+}
+
+void ImportCache::store(const std::string& persistentKey, const Geometry& geom) const
+{
+  const auto *ps = dynamic_cast<const PolySet *>(&geom);
+  const auto *poly = dynamic_cast<const Polygon2d *>(&geom);
+  // Other geometry types (e.g. Nef polyhedra) are only cached in memory
+  if (!ps && !poly) return;
+
+  std::error_code ec;
+  const auto dir = fs::u8path(this->persistentPath);
+  fs::create_directories(dir, ec);
+  const auto name = to_hex(hash_bytes(FNV_OFFSET, persistentKey.data(), persistentKey.size())) + ".geom";
+  const auto file = dir / name;
+  // Write to a temporary file first, so concurrent instances never see partial entries
+  const auto tmp = dir / (name + ".tmp" + std::to_string(reinterpret_cast<uintptr_t>(&geom)));
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) return;
+    write_pod(out, PERSISTENT_MAGIC);
+    write_pod(out, PERSISTENT_VERSION);
+    write_string(out, persistentKey);
+    if (ps) write_polyset(out, *ps);
+    else write_polygon2d(out, *poly);
+    if (!out) {
+      out.close();
+      fs::remove(tmp, ec);
+      return;
+    }
+  }
+  fs::rename(tmp, file, ec);
+  if (ec) fs::remove(tmp, ec);
+}
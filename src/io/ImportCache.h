@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Cache.h"
+#include "geometry/Geometry.h"
+
+class ImportNode;
+
+/*!
+   Caches the result of import() independently of the node tree.
+
+   Entries are keyed by the canonical file path, file size, modification
+   time, a hash of the file content and the import parameters. This makes
+   repeated imports of the same (unchanged) file cheap, even when the
+   surrounding tree changes and GeometryCache misses.
+
+   Optionally, imported PolySets and Polygon2ds are also written to a
+   directory, so they can be reused across runs. Persistent entries are
+   keyed by content hash and import parameters only, so they survive
+   touching or moving the file.
+ */
+class ImportCache
+{
+public:
+  ImportCache(size_t memorylimit = 1024ul * 1024ul * 1024ul) : cache(memorylimit) {}
+
+  static ImportCache *instance()
+  {
+    if (!inst) inst = new ImportCache;
+    return inst;
+  }
+
+  // Returns the cache key for the node, or an empty string if the import
+  // can't be cached (e.g. the file does not exist). If allowHashing is false,
+  // an empty string is also returned if the file content would need to be hashed.
+  std::string getKey(const ImportNode& node, bool allowHashing = true);
+
+  bool contains(const std::string& key) const { return this->cache.contains(key); }
+  // Looks up the in-memory cache, then the persistent cache. Returns
+  // nullptr on a miss.
+  std::shared_ptr<const Geometry> get(const std::string& key);
+  bool insert(const std::string& key, const std::shared_ptr<const Geometry>& geom);
+
+  size_t size() const { return cache.size(); }
+  size_t totalCost() const { return cache.totalCost(); }
+  size_t maxSizeMB() const;
+  void setMaxSizeMB(size_t limit);
+  void clear();
+  void print();
+
+  // An empty path disables the persistent cache
+  void setPersistentPath(const std::string& path) { this->persistentPath = path; }
+  const std::string& getPersistentPath() const { return this->persistentPath; }
+
+private:
+  static ImportCache *inst;
+
+  struct cache_entry {
+    std::shared_ptr<const Geometry> geom;
+    std::string persistentKey;
+    cache_entry(const std::shared_ptr<const Geometry>& geom, std::string persistentKey)
+      : geom(geom), persistentKey(std::move(persistentKey))
+    {
+    }
+  };
+
+  // Content hashes are only recomputed when size or modification time change
+  struct file_hash {
+    uintmax_t size;
+    time_t mtime;
+    uint64_t hash;
+  };
+
+  std::string persistentKey(const std::string& key) const;
+  std::shared_ptr<const Geometry> load(const std::string& persistentKey) const;
+  void store(const std::string& persistentKey, const Geometry& geom) const;
+
+  Cache<std::string, cache_entry> cache;
+  std::unordered_map<std::string, file_hash> hashes;
+  // Maps in-memory keys to the key used for the persistent cache. Only needed from
+  // getKey() until the get() or insert() following it, so it's cleared once it grows large.
+  std::unordered_map<std::string, std::string> persistentKeys;
+  std::string persistentPath;
+};
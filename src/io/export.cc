@@ -323,6 +323,7 @@ std::unique_ptr<PolySet> createSortedPolySet(const PolySet& ps)
   out->setConvexity(ps.getConvexity());
 
   std::map<Vector3d, int, LexographicLess> vertexMap;
+  auto& indices = out->indices.mut();
 
   for (const auto& poly : ps.indices) {
     IndexedFace face;
@@ -330,20 +331,21 @@ std::unique_ptr<PolySet> createSortedPolySet(const PolySet& ps)
       auto pos = vertexMap.emplace(remove_negative_zero(ps.vertices[idx]), vertexMap.size());
       face.push_back(pos.first->second);
     }
-    out->indices.push_back(face);
+    indices.push_back(face);
   }
   out->color_indices = ps.color_indices;
   out->colors = ps.colors;
 
   std::vector<int> indexTranslationMap(vertexMap.size());
-  out->vertices.reserve(vertexMap.size());
+  auto& vertices = out->vertices.mut();
+  vertices.reserve(vertexMap.size());
 
   for (const auto& [v, i] : vertexMap) {
-    indexTranslationMap[i] = out->vertices.size();
-    out->vertices.push_back(v);
+    indexTranslationMap[i] = vertices.size();
+    vertices.push_back(v);
   }
 
-  for (auto& poly : out->indices) {
+  for (auto& poly : indices) {
     IndexedFace polygon;
     for (const auto idx : poly) {
       polygon.push_back(indexTranslationMap[idx]);
@@ -352,23 +354,24 @@ std::unique_ptr<PolySet> createSortedPolySet(const PolySet& ps)
     poly = polygon;
   }
   if (ps.color_indices.empty()) {
-    std::sort(out->indices.begin(), out->indices.end());
+    std::sort(indices.begin(), indices.end());
   } else {
     struct ColoredFace {
       IndexedFace face;
       int32_t color_index;
     };
+    auto& color_indices = out->color_indices.mut();
     std::vector<ColoredFace> faces;
     faces.reserve(ps.indices.size());
     for (size_t i = 0, n = ps.indices.size(); i < n; i++) {
-      faces.push_back({out->indices[i], out->color_indices[i]});
+      faces.push_back({indices[i], color_indices[i]});
     }
     std::sort(faces.begin(), faces.end(),
               [](const ColoredFace& a, const ColoredFace& b) { return a.face < b.face; });
     for (size_t i = 0, n = faces.size(); i < n; i++) {
       auto& face = faces[i];
-      out->indices[i] = face.face;
-      out->color_indices[i] = face.color_index;
+      indices[i] = face.face;
+      color_indices[i] = face.color_index;
     }
   }
   return out;
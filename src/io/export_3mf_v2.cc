@@ -35,6 +35,7 @@
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <lib3mf_implicit.hpp>
 
@@ -46,6 +47,7 @@
 #include "geometry/linalg.h"
 #include "geometry/PolySet.h"
 #include "geometry/PolySetUtils.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 #ifdef ENABLE_CGAL
@@ -66,6 +68,7 @@ struct ExportContext {
   Lib3MF::PColorGroup colorgroup;
   Lib3MF::PBaseMaterialGroup basematerialgroup;
   int modelcount;
+  int meshcount;
   ExportColorMap colors;
   Color4f selectedColor;
   const ExportInfo& info;
@@ -89,21 +92,69 @@ void export_3mf_error(std::string msg)
   LOG(message_group::Export_Error, std::move(msg));
 }
 
-int count_mesh_objects(const Lib3MF::PModel& model)
+/*
+ * Lib3MF buffers for a single mesh object. These are built independently
+ * per object (in parallel if available) and handed to Lib3MF in bulk, as
+ * adding vertices and triangles one by one through the Lib3MF API is slow.
+ */
+struct MeshBuffers {
+  std::shared_ptr<const PolySet> ps;
+  int modelcount;
+  std::vector<Lib3MF::sPosition> vertices;
+  std::vector<Lib3MF::sTriangle> triangles;
+  // Indices into ps->colors, in order of first use by a triangle
+  std::vector<int32_t> used_colors;
+  // True if every triangle has a color index >= 0
+  bool all_colored = false;
+};
+
+/*
+ * PolySet must be triangulated.
+ */
+MeshBuffers create_mesh_buffers(std::shared_ptr<const PolySet> ps, int modelcount)
 {
-  const auto mesh_object_it = model->GetMeshObjects();
-  int count = 0;
-  while (mesh_object_it->MoveNext()) ++count;
-  return count;
+  if (Feature::ExperimentalPredictibleOutput.is_enabled()) {
+    ps = createSortedPolySet(*ps);
+  }
+
+  MeshBuffers buffers{.ps = ps, .modelcount = modelcount};
+  buffers.vertices.resize(ps->vertices.size());
+  std::transform(ps->vertices.begin(), ps->vertices.end(), buffers.vertices.begin(),
+                 [](const Vector3d& coords) {
+                   const auto f = coords.cast<float>();
+                   return Lib3MF::sPosition{f[0], f[1], f[2]};
+                 });
+  buffers.triangles.resize(ps->indices.size());
+  std::transform(ps->indices.begin(), ps->indices.end(), buffers.triangles.begin(),
+                 [](const IndexedFace& indices) {
+                   return Lib3MF::sTriangle{static_cast<Lib3MF_uint32>(indices[0]),
+                                            static_cast<Lib3MF_uint32>(indices[1]),
+                                            static_cast<Lib3MF_uint32>(indices[2])};
+                 });
+
+  if (!ps->colors.empty()) {
+    std::vector<bool> seen(ps->colors.size(), false);
+    buffers.all_colored = ps->color_indices.size() >= ps->indices.size();
+    for (size_t i = 0; i < ps->indices.size(); ++i) {
+      const auto color_index = i < ps->color_indices.size() ? ps->color_indices[i] : -1;
+      if (color_index < 0) {
+        buffers.all_colored = false;
+      } else if (!seen[color_index]) {
+        seen[color_index] = true;
+        buffers.used_colors.push_back(color_index);
+      }
+    }
+  }
+  return buffers;
 }
 
-void handle_triangle_color(const std::shared_ptr<const PolySet>& ps, ExportContext& ctx,
-                           Lib3MF::PMeshObject& mesh, Lib3MF_uint32 triangle, int color_index)
+/*
+ * Registers the colors used by the mesh with the 3MF color or material group
+ * and assigns the triangle properties.
+ */
+void handle_mesh_colors(const MeshBuffers& buffers, ExportContext& ctx, Lib3MF::PMeshObject& mesh)
 {
-  if (color_index < 0) {
-    return;
-  }
-  if (ps->colors.empty()) {
+  if (buffers.used_colors.empty()) {
     return;
   }
   if (!ctx.basematerialgroup && !ctx.colorgroup) {
@@ -113,25 +164,30 @@ void handle_triangle_color(const std::shared_ptr<const PolySet>& ps, ExportConte
     return;
   }
 
-  const Color4f col = ps->colors[color_index];
-  const auto col_it = ctx.colors.find(col);
+  // Maps PolySet color index -> property index in the 3MF group
+  std::vector<Lib3MF_uint32> property_ids(buffers.ps->colors.size(), 0);
+  for (const auto color_index : buffers.used_colors) {
+    const Color4f col = buffers.ps->colors[color_index];
+    const auto col_it = ctx.colors.find(col);
 
-  Lib3MF_uint32 col_idx = 0;
-  if (col_it == ctx.colors.end()) {
-    Lib3MF::sColor materialcolor;
-    if (!col.getRgba(materialcolor.m_Red, materialcolor.m_Green, materialcolor.m_Blue,
-                     materialcolor.m_Alpha)) {
-      LOG(message_group::Warning, "Invalid color in 3MF export");
-    }
-    if (ctx.basematerialgroup) {
-      col_idx = ctx.basematerialgroup->AddMaterial(
-        "Color " + std::to_string(ctx.basematerialgroup->GetCount()), materialcolor);
-    } else if (ctx.colorgroup) {
-      col_idx = ctx.colorgroup->AddColor(materialcolor);
+    Lib3MF_uint32 col_idx = 0;
+    if (col_it == ctx.colors.end()) {
+      Lib3MF::sColor materialcolor;
+      if (!col.getRgba(materialcolor.m_Red, materialcolor.m_Green, materialcolor.m_Blue,
+                       materialcolor.m_Alpha)) {
+        LOG(message_group::Warning, "Invalid color in 3MF export");
+      }
+      if (ctx.basematerialgroup) {
+        col_idx = ctx.basematerialgroup->AddMaterial(
+          "Color " + std::to_string(ctx.basematerialgroup->GetCount()), materialcolor);
+      } else if (ctx.colorgroup) {
+        col_idx = ctx.colorgroup->AddColor(materialcolor);
+      }
+      ctx.colors[col] = col_idx;
+    } else {
+      col_idx = (*col_it).second;
     }
-    ctx.colors[col] = col_idx;
-  } else {
-    col_idx = (*col_it).second;
+    property_ids[color_index] = col_idx;
   }
 
   Lib3MF_uint32 res_id = 0;
@@ -140,25 +196,39 @@ void handle_triangle_color(const std::shared_ptr<const PolySet>& ps, ExportConte
   } else if (ctx.colorgroup) {
     res_id = ctx.colorgroup->GetUniqueResourceID();
   }
+  if (res_id == 0) {
+    return;
+  }
 
-  if (res_id > 0) {
-    mesh->SetTriangleProperties(triangle, {res_id, {col_idx, col_idx, col_idx}});
+  const auto& color_indices = buffers.ps->color_indices;
+  if (buffers.all_colored) {
+    std::vector<Lib3MF::sTriangleProperties> properties(buffers.triangles.size());
+    parallelizable_transform(color_indices.begin(), color_indices.begin() + properties.size(),
+                             properties.begin(), [&](int32_t color_index) {
+                               const auto col_idx = property_ids[color_index];
+                               return Lib3MF::sTriangleProperties{res_id, {col_idx, col_idx, col_idx}};
+                             });
+    mesh->SetAllTriangleProperties(properties);
+  } else {
+    // Triangles without a color keep the object level property
+    for (size_t i = 0; i < buffers.triangles.size() && i < color_indices.size(); ++i) {
+      if (color_indices[i] < 0) continue;
+      const auto col_idx = property_ids[color_indices[i]];
+      mesh->SetTriangleProperties(i, {res_id, {col_idx, col_idx, col_idx}});
+    }
   }
 }
 
-/*
- * PolySet must be triangulated.
- */
-bool append_polyset(const std::shared_ptr<const PolySet>& ps, ExportContext& ctx)
+bool append_mesh(const MeshBuffers& buffers, ExportContext& ctx)
 {
   try {
     auto mesh = ctx.model->AddMeshObject();
     if (!mesh) return false;
 
-    const int mesh_count = count_mesh_objects(ctx.model);
+    const int mesh_count = ++ctx.meshcount;
     const auto modelname =
-      ctx.modelcount == 1 ? "OpenSCAD Model" : "OpenSCAD Model " + std::to_string(mesh_count);
-    const auto partname = ctx.modelcount == 1 ? "" : "Part " + std::to_string(mesh_count);
+      buffers.modelcount == 1 ? "OpenSCAD Model" : "OpenSCAD Model " + std::to_string(mesh_count);
+    const auto partname = buffers.modelcount == 1 ? "" : "Part " + std::to_string(mesh_count);
     mesh->SetName(modelname);
     if (ctx.basematerialgroup) {
       mesh->SetObjectLevelProperty(ctx.basematerialgroup->GetUniqueResourceID(), 1);
@@ -166,50 +236,20 @@ bool append_polyset(const std::shared_ptr<const PolySet>& ps, ExportContext& ctx
       mesh->SetObjectLevelProperty(ctx.colorgroup->GetUniqueResourceID(), 1);
     }
 
-    auto vertexFunc = [&](const Vector3d& coords) -> bool {
-      const auto f = coords.cast<float>();
-      try {
-        const Lib3MF::sPosition v{f[0], f[1], f[2]};
-        mesh->AddVertex(v);
-      } catch (Lib3MF::ELib3MFException& e) {
-        export_3mf_error(e.what());
-        return false;
-      }
-      return true;
-    };
-
-    auto triangleFunc = [&](const IndexedFace& indices, int color_index) -> bool {
-      try {
-        const auto triangle = mesh->AddTriangle({static_cast<Lib3MF_uint32>(indices[0]),
-                                                 static_cast<Lib3MF_uint32>(indices[1]),
-                                                 static_cast<Lib3MF_uint32>(indices[2])});
-
-        handle_triangle_color(ps, ctx, mesh, triangle, color_index);
-      } catch (Lib3MF::ELib3MFException& e) {
-        export_3mf_error(e.what());
-        return false;
-      }
-      return true;
-    };
-
-    std::shared_ptr<const PolySet> out_ps = ps;
-    if (Feature::ExperimentalPredictibleOutput.is_enabled()) {
-      out_ps = createSortedPolySet(*ps);
-    }
-
-    for (const auto& v : out_ps->vertices) {
-      if (!vertexFunc(v)) {
-        export_3mf_error("Can't add vertex to 3MF model.");
-        return false;
-      }
+    try {
+      mesh->SetGeometry(buffers.vertices, buffers.triangles);
+    } catch (Lib3MF::ELib3MFException& e) {
+      export_3mf_error(e.what());
+      export_3mf_error("Can't add mesh to 3MF model.");
+      return false;
     }
 
-    for (size_t i = 0; i < out_ps->indices.size(); i++) {
-      auto color_index = i < out_ps->color_indices.size() ? out_ps->color_indices[i] : -1;
-      if (!triangleFunc(out_ps->indices[i], color_index)) {
-        export_3mf_error("Can't add triangle to 3MF model.");
-        return false;
-      }
+    try {
+      handle_mesh_colors(buffers, ctx, mesh);
+    } catch (Lib3MF::ELib3MFException& e) {
+      export_3mf_error(e.what());
+      export_3mf_error("Can't add triangle to 3MF model.");
+      return false;
     }
 
     try {
@@ -228,11 +268,11 @@ bool append_polyset(const std::shared_ptr<const PolySet>& ps, ExportContext& ctx
 }
 
 #ifdef ENABLE_CGAL
-bool append_nef(const CGALNefGeometry& root_N, ExportContext& ctx)
+std::shared_ptr<const PolySet> nef_to_polyset(const CGALNefGeometry& root_N)
 {
   if (!root_N.p3) {
     LOG(message_group::Export_Error, "Export failed, empty geometry.");
-    return false;
+    return nullptr;
   }
 
   if (!root_N.p3->is_simple()) {
@@ -240,31 +280,38 @@ bool append_nef(const CGALNefGeometry& root_N, ExportContext& ctx)
         "Exported object may not be a valid 2-manifold and may need repair");
   }
 
-  if (const std::shared_ptr<const PolySet> ps = CGALUtils::createPolySetFromNefPolyhedron3(*root_N.p3)) {
-    return append_polyset(ps, ctx);
+  if (std::shared_ptr<const PolySet> ps = CGALUtils::createPolySetFromNefPolyhedron3(*root_N.p3)) {
+    return ps;
   }
   export_3mf_error("Error converting NEF Polyhedron.");
-  return false;
+  return nullptr;
 }
 #endif  // ifdef ENABLE_CGAL
 
-bool append_3mf(const std::shared_ptr<const Geometry>& geom, ExportContext& ctx)
+/*
+ * Flattens the geometry into a list of triangulated PolySets, one per
+ * exported mesh object, paired with the size of the list they belong to.
+ */
+bool collect_polysets(const std::shared_ptr<const Geometry>& geom, int& modelcount,
+                      std::vector<std::pair<std::shared_ptr<const PolySet>, int>>& polysets)
 {
   if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
-    ctx.modelcount = geomlist->getChildren().size();
+    modelcount = geomlist->getChildren().size();
     for (const auto& item : geomlist->getChildren()) {
-      if (!append_3mf(item.second, ctx)) return false;
+      if (!collect_polysets(item.second, modelcount, polysets)) return false;
     }
 #ifdef ENABLE_CGAL
   } else if (const auto N = std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) {
-    return append_nef(*N, ctx);
+    const auto ps = nef_to_polyset(*N);
+    if (!ps) return false;
+    polysets.emplace_back(ps, modelcount);
 #endif
 #ifdef ENABLE_MANIFOLD
   } else if (const auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
-    return append_polyset(mani->toPolySet(), ctx);
+    polysets.emplace_back(mani->toPolySet(), modelcount);
 #endif
   } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
-    return append_polyset(PolySetUtils::tessellate_faces(*ps), ctx);
+    polysets.emplace_back(PolySetUtils::tessellate_faces(*ps), modelcount);
   } else if (std::dynamic_pointer_cast<const Polygon2d>(geom)) {
     assert(false && "Unsupported file format");
   } else {
@@ -274,6 +321,24 @@ bool append_3mf(const std::shared_ptr<const Geometry>& geom, ExportContext& ctx)
   return true;
 }
 
+bool append_3mf(const std::shared_ptr<const Geometry>& geom, ExportContext& ctx)
+{
+  std::vector<std::pair<std::shared_ptr<const PolySet>, int>> polysets;
+  if (!collect_polysets(geom, ctx.modelcount, polysets)) return false;
+
+  std::vector<MeshBuffers> buffers(polysets.size());
+  parallelizable_transform(polysets.begin(), polysets.end(), buffers.begin(), [](const auto& item) {
+    return create_mesh_buffers(item.first, item.second);
+  });
+
+  // Lib3MF objects and the color map are not thread safe, so the buffers
+  // are added to the model in order.
+  for (const auto& mesh_buffers : buffers) {
+    if (!append_mesh(mesh_buffers, ctx)) return false;
+  }
+  return true;
+}
+
 void add_meta_data(Lib3MF::PMetaDataGroup& metadatagroup, const std::string& name,
                    const std::string& value, const std::string& value2 = "")
 {
@@ -389,6 +454,7 @@ void export_3mf(const std::shared_ptr<const Geometry>& geom, std::ostream& outpu
                     .colorgroup = colorgroup,
                     .basematerialgroup = basematerialgroup,
                     .modelcount = 1,
+                    .meshcount = 0,
                     .selectedColor = color,
                     .info = exportInfo,
                     .options = options3mf};
@@ -44,6 +44,7 @@
 #include <cstddef>
 #include <map>
 #include <cassert>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <libxml/xmlreader.h>
@@ -93,6 +94,12 @@ private:
   int streamFile(const char *filename);
   void processNode(xmlTextReaderPtr reader);
 
+  static cb_func lookup(const std::map<const std::string, cb_func>& map, const std::string& key)
+  {
+    const auto it = map.find(key);
+    return it == map.end() ? nullptr : it->second;
+  }
+
 protected:
   const Location& loc;
 
@@ -108,34 +115,42 @@ AmfImporter::AmfImporter(const Location& loc) : loc(loc)
 {
 }
 
+// Parses the text content in place, without copying it into a std::string first
+template <typename T>
+static T parse_value(const xmlChar *value)
+{
+  const char *text = reinterpret_cast<const char *>(value);
+  return boost::lexical_cast<T>(text, std::strlen(text));
+}
+
 void AmfImporter::set_x(AmfImporter *importer, const xmlChar *value)
 {
-  importer->x = boost::lexical_cast<double>(std::string((const char *)value));
+  importer->x = parse_value<double>(value);
 }
 
 void AmfImporter::set_y(AmfImporter *importer, const xmlChar *value)
 {
-  importer->y = boost::lexical_cast<double>(std::string((const char *)value));
+  importer->y = parse_value<double>(value);
 }
 
 void AmfImporter::set_z(AmfImporter *importer, const xmlChar *value)
 {
-  importer->z = boost::lexical_cast<double>(std::string((const char *)value));
+  importer->z = parse_value<double>(value);
 }
 
 void AmfImporter::set_v1(AmfImporter *importer, const xmlChar *value)
 {
-  importer->idx_v1 = boost::lexical_cast<int>(std::string((const char *)value));
+  importer->idx_v1 = parse_value<int>(value);
 }
 
 void AmfImporter::set_v2(AmfImporter *importer, const xmlChar *value)
 {
-  importer->idx_v2 = boost::lexical_cast<int>(std::string((const char *)value));
+  importer->idx_v2 = parse_value<int>(value);
 }
 
 void AmfImporter::set_v3(AmfImporter *importer, const xmlChar *value)
 {
-  importer->idx_v3 = boost::lexical_cast<int>(std::string((const char *)value));
+  importer->idx_v3 = parse_value<int>(value);
 }
 
 void AmfImporter::start_object(AmfImporter *importer, const xmlChar *)
@@ -173,22 +188,23 @@ void AmfImporter::end_triangle(AmfImporter *importer, const xmlChar *)
 
 void AmfImporter::processNode(xmlTextReaderPtr reader)
 {
-  const char *name = reinterpret_cast<const char *>(xmlTextReaderName(reader));
-  if (name == nullptr) name = reinterpret_cast<const char *>(xmlStrdup(BAD_CAST "--"));
-  xmlChar *value = xmlTextReaderValue(reader);
+  // The const accessors return strings owned by the reader, valid until the next read
+  const char *name = reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
+  if (name == nullptr) name = "--";
+  const xmlChar *value = xmlTextReaderConstValue(reader);
   int node_type = xmlTextReaderNodeType(reader);
   switch (node_type) {
   case XML_READER_TYPE_ELEMENT: {
     xpath += '/';
     xpath += name;
-    cb_func startFunc = start_funcs[xpath];
+    cb_func startFunc = lookup(start_funcs, xpath);
     if (startFunc) {
       PRINTDB("AMF: start %s", xpath);
       startFunc(this, nullptr);
     }
   } break;
   case XML_READER_TYPE_END_ELEMENT: {
-    cb_func endFunc = end_funcs[xpath];
+    cb_func endFunc = lookup(end_funcs, xpath);
     if (endFunc) {
       PRINTDB("AMF: end   %s", xpath);
       endFunc(this, value);
@@ -197,16 +213,13 @@ void AmfImporter::processNode(xmlTextReaderPtr reader)
     if (pos != std::string::npos) xpath.erase(pos);
   } break;
   case XML_READER_TYPE_TEXT: {
-    cb_func textFunc = funcs[xpath];
+    cb_func textFunc = lookup(funcs, xpath);
     if (textFunc) {
       PRINTDB("AMF: text  %s - '%s'", xpath % value);
       textFunc(this, value);
     }
   } break;
   }
-
-  xmlFree(value);
-  xmlFree((void *)(name));
 }
 
 xmlTextReaderPtr AmfImporter::createXmlReader(const char *filename)
@@ -0,0 +1,76 @@
+#include <catch2/catch_all.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "core/AST.h"
+#include "geometry/PolySet.h"
+#include "io/export.h"
+#include "io/import.h"
+
+namespace {
+
+// A triangulated torus with 2 * rings * segments faces
+std::shared_ptr<const PolySet> createTorus(int rings, int segments)
+{
+  auto ps = std::make_shared<PolySet>(3);
+  ps->setTriangular(true);
+  for (int i = 0; i < rings; ++i) {
+    const double phi = 2 * M_PI * i / rings;
+    for (int j = 0; j < segments; ++j) {
+      const double theta = 2 * M_PI * j / segments;
+      const double r = 10 + 3 * std::cos(theta);
+      ps->vertices.emplace_back(r * std::cos(phi), r * std::sin(phi), 3 * std::sin(theta));
+    }
+  }
+  for (int i = 0; i < rings; ++i) {
+    for (int j = 0; j < segments; ++j) {
+      const int next_i = (i + 1) % rings, next_j = (j + 1) % segments;
+      const int a = i * segments + j, b = next_i * segments + j;
+      const int c = next_i * segments + next_j, d = i * segments + next_j;
+      ps->indices.push_back({a, b, c});
+      ps->indices.push_back({a, c, d});
+    }
+  }
+  return ps;
+}
+
+}  // namespace
+
+TEST_CASE("STL export and import", "[.][benchmark][STL]")
+{
+  const auto ps = createTorus(300, 300);
+
+  BENCHMARK("STL binary export 180k triangles")
+  {
+    std::ostringstream out;
+    export_stl(ps, out, true);
+    return out.tellp();
+  };
+  BENCHMARK("STL ASCII export 180k triangles")
+  {
+    std::ostringstream out;
+    export_stl(ps, out, false);
+    return out.tellp();
+  };
+
+  const auto dir = std::filesystem::temp_directory_path();
+  for (const bool binary : {true, false}) {
+    const auto path = dir / (binary ? "openscad-benchmark-binary.stl" : "openscad-benchmark-ascii.stl");
+    {
+      std::ofstream out(path, std::ios::binary);
+      export_stl(ps, out, binary);
+    }
+    const std::string filename = path.string();
+    BENCHMARK(binary ? "STL binary import 180k triangles" : "STL ASCII import 180k triangles")
+    {
+      return import_stl(filename, Location::NONE);
+    };
+    std::filesystem::remove(path);
+  }
+}
@@ -24,19 +24,23 @@
  */
 #include "libsvg/libsvg.h"
 
+#include <deque>
 #include <utility>
 #include <iostream>
 #include <memory>
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <boost/format.hpp>
 #include <libxml/xmlreader.h>
 
+#include "libsvg/path.h"
 #include "libsvg/shape.h"
 #include "libsvg/use.h"
+#include "utils/parallel.h"
 
 namespace libsvg {
 
@@ -62,42 +66,57 @@ static std::string dump_stack()
 }
 #endif  // if SVG_DEBUG
 
-attr_map_t read_attributes(xmlTextReaderPtr reader)
+/*
+ * Collects the attributes of the current element. Names and values point
+ * directly into the reader's dictionary and node tree where possible;
+ * values libxml2 has to assemble (e.g. from multiple text nodes) are copied
+ * into storage, which must outlive the returned map.
+ */
+attr_map_t read_attributes(xmlTextReaderPtr reader, std::deque<std::string>& storage)
 {
   attr_map_t attrs;
   int attr_count = xmlTextReaderAttributeCount(reader);
   for (int idx = 0; idx < attr_count; ++idx) {
     xmlTextReaderMoveToAttributeNo(reader, idx);
-    const char *name = reinterpret_cast<const char *>(xmlTextReaderName(reader));
-    const char *value = reinterpret_cast<const char *>(xmlTextReaderValue(reader));
-    attrs[name] = value;
+    const char *name = reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
+    if (name == nullptr) continue;
+    const xmlNode *node = xmlTextReaderCurrentNode(reader);
+    if (node && node->type == XML_ATTRIBUTE_NODE && node->children &&
+        node->children->type == XML_TEXT_NODE && node->children->next == nullptr) {
+      attrs[name] = reinterpret_cast<const char *>(node->children->content);
+    } else {
+      const char *value = reinterpret_cast<const char *>(xmlTextReaderConstValue(reader));
+      attrs[name] = storage.emplace_back(value ? value : "");
+    }
   }
+  xmlTextReaderMoveToElement(reader);
   return attrs;
 }
 
 void processNode(xmlTextReaderPtr reader, shapes_defs_list_t *defs_lookup_list,
                  shapes_list_t *temp_defs_storage, void *context)
 {
-  const char *name = reinterpret_cast<const char *>(xmlTextReaderName(reader));
-  if (name == nullptr) name = reinterpret_cast<const char *>(xmlStrdup(BAD_CAST "--"));
+  const char *const_name = reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
+  const std::string_view name = const_name ? const_name : "--";
 
   bool isEmpty;
-  xmlChar *value = xmlTextReaderValue(reader);
   int node_type = xmlTextReaderNodeType(reader);
   switch (node_type) {
   case XML_READER_TYPE_ELEMENT: isEmpty = xmlTextReaderIsEmptyElement(reader); {
 #if SVG_DEBUG
-      printf("XML_READER_TYPE_ELEMENT (%s %s): %d %d %s\n", dump_stack().c_str(), name,
-             xmlTextReaderDepth(reader), xmlTextReaderNodeType(reader), value);
+      printf("XML_READER_TYPE_ELEMENT (%s %s): %d %d %s\n", dump_stack().c_str(), name.data(),
+             xmlTextReaderDepth(reader), xmlTextReaderNodeType(reader),
+             xmlTextReaderConstValue(reader));
 #endif
 
-      if (std::string("defs") == name) {
+      if (name == "defs") {
         in_defs = true;
       }
 
-      auto s = std::shared_ptr<shape>(shape::create_from_name(name));
+      auto s = std::shared_ptr<shape>(shape::create_from_name(name.data()));
       if (s) {
-        attr_map_t attrs = read_attributes(reader);
+        std::deque<std::string> storage;
+        attr_map_t attrs = read_attributes(reader, storage);
         if (!stack.empty()) {
           stack.back()->add_child(s.get());
         }
@@ -132,22 +151,23 @@ void processNode(xmlTextReaderPtr reader, shapes_defs_list_t *defs_lookup_list,
     }
   /* fall through */
   case XML_READER_TYPE_END_ELEMENT: {
-    if (std::string("defs") == name) {
+    if (name == "defs") {
       in_defs = false;
     }
 
-    if (std::string("g") == name || std::string("svg") == name || std::string("tspan") == name ||
-        std::string("text") == name) {
+    if (name == "g" || name == "svg" || name == "tspan" || name == "text") {
       stack.pop_back();
     }
 #if SVG_DEBUG
-    printf("XML_READER_TYPE_END_ELEMENT (%s %s): %d %d %s\n", dump_stack().c_str(), name,
-           xmlTextReaderDepth(reader), xmlTextReaderNodeType(reader), value);
+    printf("XML_READER_TYPE_END_ELEMENT (%s %s): %d %d %s\n", dump_stack().c_str(), name.data(),
+           xmlTextReaderDepth(reader), xmlTextReaderNodeType(reader),
+           xmlTextReaderConstValue(reader));
 #endif
   } break;
   case XML_READER_TYPE_TEXT: {
+    const char *value = reinterpret_cast<const char *>(xmlTextReaderConstValue(reader));
     attr_map_t attrs;
-    attrs["text"] = reinterpret_cast<const char *>(value);
+    attrs["text"] = value ? value : "";
     auto s = std::shared_ptr<shape>(shape::create_from_name("data"));
     if (!stack.empty()) {
       stack.back()->add_child(s.get());
@@ -160,9 +180,6 @@ void processNode(xmlTextReaderPtr reader, shapes_defs_list_t *defs_lookup_list,
     }
   } break;
   }
-
-  xmlFree(value);
-  xmlFree((void *)(name));
 }
 
 int streamFile(const char *filename, void *context)
@@ -189,6 +206,16 @@ int streamFile(const char *filename, void *context)
     throw SvgException((boost::format("Can't open file '%1%'") % filename).str());
   }
 
+  // Path data does not depend on other elements, so all paths (including
+  // the ones cloned by <use>) can be flattened independently.
+  std::vector<path *> paths;
+  for (const auto& shape : (*shape_list)) {
+    if (auto *p = dynamic_cast<path *>(shape.get())) {
+      paths.push_back(p);
+    }
+  }
+  parallelizable_for_each(paths.begin(), paths.end(), [context](path *p) { p->flatten(context); });
+
   for (const auto& shape : (*shape_list)) {
     shape->apply_transform();
   }
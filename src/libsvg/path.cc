@@ -32,13 +32,12 @@
 #include <iostream>
 #include <cmath>
 #include <cctype>
-#include <string>
+#include <cstring>
+#include <string_view>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
-#include <boost/tokenizer.hpp>
-#include <boost/algorithm/string.hpp>
 
 #include "utils/degree_trig.h"
 #include "utils/calc.h"
@@ -46,8 +45,6 @@
 
 namespace libsvg {
 
-using tokenizer = boost::tokenizer<boost::char_separator<char>>;
-
 const std::string path::name("path");
 
 /*
@@ -183,54 +180,110 @@ void path::curve_to(path_t& path, double x, double y, double cx1, double cy1, do
   }
 }
 
+namespace {
+
 /**
- * Workaround for parsing ",1-23.16.88" where the number split
- * happens implicitly at the dot.
+ * Splits SVG path data into command letters and numbers in place, without
+ * allocating. Handles the compact forms allowed by the path data grammar,
+ * e.g. "1-2" and ".5.5" (two numbers each), exponents like "1e-5", and arc
+ * flags that are not separated from the following number ("a1 1 0 00 1 1").
  */
-static std::vector<std::string> split_dots(const std::string& str)
+class path_tokenizer
 {
-  std::vector<std::string> result;
-  const size_t n = std::count(str.begin(), str.end(), '.');
-  if (n < 2) {
-    result.push_back(str);
-    return result;
+public:
+  struct token {
+    char cmd;  // command letter, or 0 for a number
+    double value;
+  };
+
+  explicit path_tokenizer(std::string_view data) : data(data) {}
+
+  bool next(token& tok, bool expect_flag)
+  {
+    bool negate = false;
+    while (pos < data.size()) {
+      const char c = data[pos];
+      if (std::isspace(static_cast<unsigned char>(c)) || c == ',') {
+        ++pos;
+        continue;
+      }
+      if (is_command(c)) {
+        ++pos;
+        tok = {c, 0};
+        return true;
+      }
+      if (expect_flag && !negate && (c == '0' || c == '1')) {
+        ++pos;
+        tok = {0, c == '1' ? 1.0 : 0.0};
+        return true;
+      }
+      const size_t start = pos;
+      const size_t len = scan_number();
+      if (len > 0) {
+        const double p = parse_double(data.substr(start, len));
+        tok = {0, negate ? -p : p};
+        return true;
+      }
+      // A sign separated from its number, e.g. "- 5", applies to the next
+      // number. Anything else that is not valid path data is skipped.
+      if (c == '-') negate = !negate;
+      ++pos;
+    }
+    return false;
   }
 
-  boost::char_separator<char> sep("", ".");
-  tokenizer tokens(str, sep);
-
-  std::string text;
-  bool dot_seen = false;
-  for (const auto& token : tokens) {
-    text += token;
-    if (token == ".") {
-      dot_seen = true;
-      continue;
-    } else if (dot_seen == true) {
-      result.push_back(text);
-      text.clear();
+private:
+  std::string_view data;
+  size_t pos{0};
+
+  static bool is_command(char c) { return c != 0 && std::strchr("zmlcqahvstZMLCQAHVST", c) != nullptr; }
+
+  static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+  // Advances over a number starting at pos, returns its length or 0 if
+  // there is no number at pos.
+  size_t scan_number()
+  {
+    const size_t start = pos;
+    size_t p = pos;
+    if (p < data.size() && (data[p] == '+' || data[p] == '-')) ++p;
+    size_t digits = 0;
+    while (p < data.size() && is_digit(data[p])) ++p, ++digits;
+    if (p < data.size() && data[p] == '.') {
+      ++p;
+      while (p < data.size() && is_digit(data[p])) ++p, ++digits;
+    }
+    if (digits == 0) return 0;
+    if (p < data.size() && (data[p] == 'e' || data[p] == 'E')) {
+      size_t e = p + 1;
+      if (e < data.size() && (data[e] == '+' || data[e] == '-')) ++e;
+      if (e < data.size() && is_digit(data[e])) {
+        while (e < data.size() && is_digit(data[e])) ++e;
+        p = e;
+      }
     }
+    pos = p;
+    return p - start;
   }
+};
 
-  return result;
-}
+}  // namespace
 
 void path::set_attrs(attr_map_t& attrs, void *context)
 {
-  std::string commands = "-zmlcqahvstZMLCQAHVST";
-
   shape::set_attrs(attrs, context);
   this->data = attrs["d"];
+}
 
-  boost::char_separator<char> sep(" ,", commands.c_str());
-  tokenizer tokens(this->data, sep);
-
-  std::vector<std::string> path_tokens;
-  for (const auto& token : tokens) {
-    const std::vector<std::string> parts = split_dots(token);
-    path_tokens.insert(path_tokens.end(), parts.begin(), parts.end());
+void path::flatten(void *context)
+{
+  if (this->data.empty()) {
+    return;
   }
 
+  path_tokenizer tokenizer(this->data);
+  path_tokenizer::token token{};
+
   double x = 0;
   double y = 0;
   double xx = 0;
@@ -249,33 +302,15 @@ void path::set_attrs(attr_map_t& attrs, void *context)
   char cmd = ' ';
   int point = 0;
 
-  bool negate = false;
   bool path_closed = false;
-  std::string pre_exp;
   path_list.push_back(path_t());
-  for (const auto& v : path_tokens) {
+  while (tokenizer.next(token, (cmd == 'a' || cmd == 'A') && (point == 3 || point == 4))) {
     double p = 0;
-    if ((v.length() == 1) && (commands.find(v) != std::string::npos)) {
-      if (v[0] == '-') {
-        negate = true;
-        continue;
-      }
+    if (token.cmd) {
       point = -1;
-      cmd = v[0];
+      cmd = token.cmd;
     } else {
-      if (std::tolower(*v.rbegin()) == 'e') {
-        pre_exp = negate ? std::string("-").append(v) : v;
-        negate = false;
-        continue;
-      }
-      if (pre_exp.empty()) {
-        p = parse_double(v);
-        p = negate ? -p : p;
-      } else {
-        p = parse_double(pre_exp.append(negate ? "-" : "").append(v));
-        pre_exp = "";
-      }
-      negate = false;
+      p = token.value;
     }
 
     switch (cmd) {
@@ -50,6 +50,10 @@ public:
   path() = default;
 
   void set_attrs(attr_map_t& attrs, void *context) override;
+  // Converts the path data into path_list. This is separate from
+  // set_attrs() so independent paths can be flattened in parallel once
+  // the whole file is read.
+  void flatten(void *context);
   [[nodiscard]] const std::string dump() const override;
   [[nodiscard]] const std::string& get_name() const override { return path::name; }
 
@@ -94,7 +94,7 @@ shape *shape::create_from_name(const char *name)
 void shape::set_attrs(attr_map_t& attrs, void *context)
 {
   if (attrs.find("id") != attrs.end()) {
-    this->id = attrs["id"];
+    this->id = std::string(attrs["id"]);
   }
   this->transform = attrs["transform"];
   this->stroke_width = attrs["stroke-width"];
@@ -113,9 +113,9 @@ void shape::set_attrs(attr_map_t& attrs, void *context)
     excluded = true;
   }
 
-  const std::string inkscape_groupmode = attrs["inkscape:groupmode"];
+  const auto inkscape_groupmode = attrs["inkscape:groupmode"];
   if (inkscape_groupmode == "layer" && attrs.find("inkscape:label") != attrs.end()) {
-    this->layer = attrs["inkscape:label"];
+    this->layer = std::string(attrs["inkscape:label"]);
   }
 
   const auto *ctx = reinterpret_cast<const fnContext *>(context);
@@ -27,6 +27,7 @@
 #include <map>
 #include <atomic>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -71,7 +72,9 @@ namespace libsvg {
 
 using path_t = std::vector<Eigen::Vector3d>;
 using path_list_t = std::vector<path_t>;
-using attr_map_t = std::map<std::string, std::string>;
+// Attribute names and values are views into the XML reader buffers and are
+// only valid during the set_attrs() call. Shapes must copy what they keep.
+using attr_map_t = std::map<std::string_view, std::string_view>;
 
 class shape
 {
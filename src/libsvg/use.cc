@@ -49,7 +49,7 @@ void use::set_attrs(attr_map_t& attrs, void *context)
   this->width = parse_double(attrs["width"]);
   this->height = parse_double(attrs["height"]);
 
-  std::string temp_href = attrs["href"];
+  std::string temp_href{attrs["href"]};
   if (attrs["href"].empty() && !attrs["xlink:href"].empty()) {
     temp_href = attrs["xlink:href"];
   }
@@ -28,6 +28,7 @@
 #include <boost/spirit/include/qi.hpp>
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 // include fusion headers for Ubuntu trusty, everything later seems happy without
@@ -40,9 +41,9 @@ namespace libsvg {
 
 namespace qi = boost::spirit::qi;
 
-double parse_double(const std::string& number)
+double parse_double(std::string_view number)
 {
-  std::string::const_iterator iter = number.begin(), end = number.end();
+  std::string_view::const_iterator iter = number.begin(), end = number.end();
 
   qi::real_parser<double, qi::real_policies<double>> double_parser;
 
@@ -77,13 +78,13 @@ static unit_t get_unit(const std::string& value)
   }
 }
 
-const length_t parse_length(const std::string& value)
+const length_t parse_length(std::string_view value)
 {
-  std::string::const_iterator it = value.begin(), end = value.end();
+  std::string_view::const_iterator it = value.begin(), end = value.end();
 
-  qi::rule<std::string::const_iterator, length_struct(), qi::space_type> length;
-  qi::rule<std::string::const_iterator, double()> number;
-  qi::rule<std::string::const_iterator, std::vector<char>()> unit;
+  qi::rule<std::string_view::const_iterator, length_struct(), qi::space_type> length;
+  qi::rule<std::string_view::const_iterator, double()> number;
+  qi::rule<std::string_view::const_iterator, std::vector<char>()> unit;
 
   length = number >> -unit;
   number = qi::double_;
@@ -102,13 +103,13 @@ const length_t parse_length(const std::string& value)
   return result;
 }
 
-const viewbox_t parse_viewbox(const std::string& value)
+const viewbox_t parse_viewbox(std::string_view value)
 {
-  std::string::const_iterator it = value.begin(), end = value.end();
+  std::string_view::const_iterator it = value.begin(), end = value.end();
 
-  qi::rule<std::string::const_iterator, std::vector<double>(), qi::space_type> viewbox;
-  qi::rule<std::string::const_iterator, double()> number;
-  qi::rule<std::string::const_iterator> sep;
+  qi::rule<std::string_view::const_iterator, std::vector<double>(), qi::space_type> viewbox;
+  qi::rule<std::string_view::const_iterator, double()> number;
+  qi::rule<std::string_view::const_iterator> sep;
 
   viewbox = number >> -sep >> number >> -sep >> number >> -sep >> number;
   number = qi::double_;
@@ -130,14 +131,14 @@ const viewbox_t parse_viewbox(const std::string& value)
   return result;
 }
 
-const alignment_t parse_alignment(const std::string& value)
+const alignment_t parse_alignment(std::string_view value)
 {
-  std::string::const_iterator it = value.begin(), end = value.end();
+  std::string_view::const_iterator it = value.begin(), end = value.end();
 
-  qi::rule<std::string::const_iterator, std::vector<std::string>(), qi::space_type> alignment;
-  qi::rule<std::string::const_iterator, std::vector<char>()> defer;
-  qi::rule<std::string::const_iterator, std::vector<char>()> align;
-  qi::rule<std::string::const_iterator, std::vector<char>()> meet_or_slice;
+  qi::rule<std::string_view::const_iterator, std::vector<std::string>(), qi::space_type> alignment;
+  qi::rule<std::string_view::const_iterator, std::vector<char>()> defer;
+  qi::rule<std::string_view::const_iterator, std::vector<char>()> align;
+  qi::rule<std::string_view::const_iterator, std::vector<char>()> meet_or_slice;
 
   alignment = -qi::as_string[defer] >> qi::as_string[align] >> -qi::as_string[meet_or_slice];
   defer = qi::string("defer");
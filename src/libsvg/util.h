@@ -26,6 +26,7 @@
 
 #include <ostream>
 #include <string>
+#include <string_view>
 
 namespace libsvg {
 
@@ -70,10 +71,10 @@ struct alignment_t {
   bool meet;
 };
 
-double parse_double(const std::string& number);
-const length_t parse_length(const std::string& value);
-const viewbox_t parse_viewbox(const std::string& value);
-const alignment_t parse_alignment(const std::string& value);
+double parse_double(std::string_view number);
+const length_t parse_length(std::string_view value);
+const viewbox_t parse_viewbox(std::string_view value);
+const alignment_t parse_alignment(std::string_view value);
 
 std::ostream& operator<<(std::ostream& stream, const unit_t& unit);
 std::ostream& operator<<(std::ostream& stream, const length_t& length);
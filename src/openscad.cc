@@ -31,13 +31,17 @@
 #include <io.h>
 #include <fcntl.h>
 #endif
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <clocale>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <ios>
 #include <iostream>
@@ -46,10 +50,13 @@
 #include <libintl.h>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -59,7 +66,9 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
 #include <boost/dll/runtime_symbol_info.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/lexical_cast/bad_lexical_cast.hpp>
@@ -84,9 +93,12 @@
 #include "core/customizer/CommentParser.h"
 #include "core/customizer/ParameterObject.h"
 #include "core/customizer/ParameterSet.h"
+#include "core/EvaluationProfiler.h"
 #include "core/EvaluationSession.h"
+#include "core/ModuleInstantiation.h"
 #include "core/node.h"
 #include "core/parsersettings.h"
+#include "core/progress.h"
 #include "core/RenderVariables.h"
 #include "core/ScopeContext.h"
 #include "core/Settings.h"
@@ -101,12 +113,19 @@
 #include "glview/RenderSettings.h"
 #include "handle_dep.h"
 #include "io/export.h"
+#include "io/fileutils.h"
+#include "io/FrameExporter.h"
+#include "io/ImportCache.h"
+#include "json/json.hpp"
 #include "LibraryInfo.h"
 #include "openscad_gui.h"
 #include "openscad_mimalloc.h"
 #include "platform/PlatformUtils.h"
+#include "RenderBudget.h"
+#include "RenderProfiler.h"
 #include "RenderStatistic.h"
 #include "utils/exceptions.h"
+#include "utils/MemoryStatistic.h"
 #include "utils/printutils.h"
 #include "utils/StackCheck.h"
 
@@ -175,6 +194,10 @@ struct CommandLine {
   const AnimateArgs animate;
   const std::vector<std::string> summaryOptions;
   const std::string summaryFile;
+  const std::string profileFile;
+  const std::vector<std::string> parameterSets;
+  const RenderBudget::Limits budget;
+  const bool progress;
 };
 
 namespace {
@@ -196,7 +219,8 @@ bool useGUI()
 #endif  // OPENSCAD_NOGUI
 
 bool checkAndExport(const std::shared_ptr<const Geometry>& root_geom, unsigned dimensions,
-                    ExportInfo& exportInfo, const bool is_stdout, const std::string& filename)
+                    ExportInfo& exportInfo, const bool is_stdout, const std::string& filename,
+                    FrameExporter *frames = nullptr)
 {
   if (root_geom->getDimension() != dimensions) {
     LOG("Current top level object is not a %1$dD object.", dimensions);
@@ -209,6 +233,8 @@ bool checkAndExport(const std::shared_ptr<const Geometry>& root_geom, unsigned d
 
   if (is_stdout) {
     exportFileStdOut(root_geom, exportInfo);
+  } else if (frames) {
+    return frames->write(root_geom, filename, exportInfo);
   } else {
     exportFileByName(root_geom, filename, exportInfo);
   }
@@ -384,9 +410,85 @@ Camera get_camera(const po::variables_map& vm)
   return camera;
 }
 
+/*!
+   Prints the progress of rendering on stderr while in scope, as lines like
+
+     PROGRESS {"elapsed":3.2,"fraction":0.42,"node":"difference","remaining":4.4}
+
+   at most twice a second. "fraction" is weighted by the estimated cost of nodes,
+   "remaining" is in seconds, or null until it can be estimated, and "node" is the
+   last node reported, along with its "location" if known. A last line with a
+   fraction of 1 follows unless rendering was aborted.
+ */
+class ProgressPrinter
+{
+public:
+  ProgressPrinter(const std::shared_ptr<const AbstractNode>& root, std::string docPath)
+    : docPath(std::move(docPath))
+  {
+    progress_report_prep(std::const_pointer_cast<AbstractNode>(root), report, this);
+  }
+  ~ProgressPrinter()
+  {
+    if (std::uncaught_exceptions() == this->uncaught) print(nullptr, 1.0, 0);
+    progress_report_fin();
+  }
+  ProgressPrinter(const ProgressPrinter&) = delete;
+  ProgressPrinter& operator=(const ProgressPrinter&) = delete;
+
+private:
+  static void report(const std::shared_ptr<const AbstractNode>& node, void *userdata, int /*mark*/)
+  {
+    auto *printer = static_cast<ProgressPrinter *>(userdata);
+    const auto now = std::chrono::steady_clock::now();
+    if (now < printer->next) return;
+    printer->next = now + std::chrono::milliseconds(500);
+    const auto estimate = progress_estimate();
+    printer->print(node.get(), estimate.fraction, estimate.remaining);
+  }
+
+  void print(const AbstractNode *node, double fraction, double remaining) const
+  {
+    nlohmann::json line = {{"fraction", std::round(fraction * 1000) / 1000},
+                           {"elapsed", progress_estimate().elapsed}};
+    line["remaining"] = remaining >= 0 ? nlohmann::json(remaining) : nlohmann::json();
+    if (node) {
+      line["node"] = node->name();
+      if (node->modinst && !node->modinst->location().isNone()) {
+        const auto& location = node->modinst->location();
+        line["location"] = fs_uncomplete(location.filePath(), this->docPath).generic_string() + ":" +
+                           std::to_string(location.firstLine());
+      }
+    }
+    std::cerr << "PROGRESS " << line.dump() << std::endl;
+  }
+
+  std::string docPath;
+  std::chrono::steady_clock::time_point next;
+  int uncaught = std::uncaught_exceptions();
+};
+
+// Restores the current path when going out of scope, however the export ends
+class CurrentPathRestorer
+{
+public:
+  explicit CurrentPathRestorer(fs::path path) : path(std::move(path)) {}
+  ~CurrentPathRestorer()
+  {
+    std::error_code ec;
+    fs::current_path(this->path, ec);
+  }
+  CurrentPathRestorer(const CurrentPathRestorer&) = delete;
+  CurrentPathRestorer& operator=(const CurrentPathRestorer&) = delete;
+
+private:
+  fs::path path;
+};
+
 int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat export_format,
-              SourceFile *root_file)
+              SourceFile *root_file, FrameExporter *frames = nullptr)
 {
+  const CurrentPathRestorer restorer(cmd.original_path);
   auto filename_str = fs::path(cmd.output_file).generic_string();
   // Avoid possibility of fs::absolute throwing when passed an empty path
   auto fpath = cmd.filename.empty() ? fs::current_path() : fs::absolute(fs::path(cmd.filename));
@@ -395,6 +497,11 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
   // set CWD relative to source file
   fs::current_path(fparent);
 
+  MemoryStatistic::trackGeometry(
+    std::any_of(cmd.summaryOptions.begin(), cmd.summaryOptions.end(), [](const std::string& option) {
+      return option == "all" || option == RenderStatistic::MEMORY;
+    }));
+  const RenderBudget::Scope budget(cmd.budget, fparent.string());
   EvaluationSession session{fparent.string()};
   ContextHandle<BuiltinContext> builtin_context{Context::create<BuiltinContext>(&session)};
   render_variables.applyToContext(builtin_context);
@@ -406,13 +513,20 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
   AbstractNode::resetIndexCounter();
   std::shared_ptr<const FileContext> file_context;
   std::shared_ptr<AbstractNode> absolute_root_node;
+  const bool profileEvaluation =
+    std::any_of(cmd.summaryOptions.begin(), cmd.summaryOptions.end(), [](const std::string& option) {
+      return option == "all" || option == RenderStatistic::EVALUATION;
+    });
 
 #ifdef ENABLE_PYTHON
   if (python_result_node != NULL && python_active) {
     absolute_root_node = python_result_node;
   } else {
 #endif
-    absolute_root_node = root_file->instantiate(*builtin_context, &file_context);
+    {
+      const EvaluationProfiler::RecordingScope profiling(profileEvaluation);
+      absolute_root_node = root_file->instantiate(*builtin_context, &file_context);
+    }
 #ifdef ENABLE_PYTHON
   }
 #endif
@@ -436,6 +550,9 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
         "More than one Root Modifier (!)");
   }
   Tree tree(root_node, fparent.string());
+  const RenderProfiler::RecordingScope profiling(fparent.string(), !cmd.profileFile.empty());
+  std::optional<ProgressPrinter> progress;
+  if (cmd.progress) progress.emplace(root_node, fparent.string());
 
   if (export_format == FileFormat::CSG) {
     // https://github.com/openscad/openscad/issues/128
@@ -509,7 +626,7 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
     const int dim = fileformat::is3D(export_format) ? 3 : fileformat::is2D(export_format) ? 2 : 0;
     ExportInfo exportInfo = createExportInfo(export_format, fileformat::info(export_format),
                                              input_filename, &cmd.camera, cmd.exportOptions);
-    if (dim > 0 && !checkAndExport(root_geom, dim, exportInfo, cmd.is_stdout, filename_str)) {
+    if (dim > 0 && !checkAndExport(root_geom, dim, exportInfo, cmd.is_stdout, filename_str, frames)) {
       return 1;
     }
 
@@ -533,9 +650,93 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
 
     renderStatistic.printAll(root_geom, camera, cmd.summaryOptions, cmd.summaryFile);
   }
+  if (!cmd.profileFile.empty() && !RenderProfiler::write(cmd.profileFile)) return 1;
   return 0;
 }
 
+/*!
+   Renders the parameter sets of cmd.parameterSets from cmd.parameterFile, or all of
+   them for "all" (unless a set has that name), one after the other into the same
+   parsed file. Output files are named by replacing "{set}" in cmd.output_file with
+   the set name. Subtrees which don't depend on the parameters changed between sets
+   are taken from the cache. Nothing is rendered if two sets would be written to the
+   same file, and a set which fails doesn't stop the others.
+ */
+int sweep(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat export_format,
+          SourceFile *root_file)
+{
+  ParameterSets sets;
+  if (!sets.readFile(cmd.parameterFile)) {
+    LOG("Can't read parameter file '%1$s'", cmd.parameterFile);
+    return 1;
+  }
+  const auto find_set = [&sets](const std::string& name) {
+    return std::find_if(sets.begin(), sets.end(),
+                        [&name](const ParameterSet& set) { return set.name() == name; });
+  };
+  std::vector<const ParameterSet *> selected;
+  if (cmd.parameterSets == std::vector<std::string>{"all"} && find_set("all") == sets.end()) {
+    for (const auto& set : sets) selected.push_back(&set);
+  } else {
+    for (const auto& name : cmd.parameterSets) {
+      const auto it = find_set(name);
+      if (it == sets.end()) {
+        LOG("Parameter set '%1$s' not found in '%2$s'", name, cmd.parameterFile);
+        return 1;
+      }
+      selected.push_back(&*it);
+    }
+  }
+  const std::string placeholder = "{set}";
+  if (selected.size() > 1 && cmd.output_file.find(placeholder) == std::string::npos) {
+    LOG("The output file name must contain %1$s to render several parameter sets.", placeholder);
+    return 1;
+  }
+
+  // Characters which can't be part of file names on some platforms
+  constexpr std::string_view reserved = "/\\:*?\"<>|";
+  std::vector<std::string> output_files;
+  for (const auto *set : selected) {
+    std::string name = set->name();
+    std::replace_if(
+      name.begin(), name.end(), [&](char c) { return reserved.find(c) != std::string_view::npos; }, '_');
+    std::string output_file = cmd.output_file;
+    boost::algorithm::replace_all(output_file, placeholder, name);
+    // Distinct set names can map to the same file once reserved characters are replaced
+    const auto other = std::find(output_files.begin(), output_files.end(), output_file);
+    if (other != output_files.end()) {
+      LOG("Parameter sets '%1$s' and '%2$s' would both be exported to %3$s.",
+          selected[other - output_files.begin()]->name(), set->name(), output_file);
+      return 1;
+    }
+    output_files.push_back(output_file);
+  }
+
+  // Taken before applying any set, so sets which leave out parameters get their defaults
+  auto parameters = ParameterObjects::fromSourceFile(root_file);
+  FrameExporter outputs;
+  int rc = 0;
+  for (size_t i = 0; i < selected.size(); ++i) {
+    const auto *set = selected[i];
+    parameters.importValues(*set);
+    parameters.apply(root_file);
+
+    CommandLine set_cmd = cmd;
+    set_cmd.output_file = output_files[i];
+    LOG("Exporting parameter set '%1$s' to %2$s...", set->name(), set_cmd.output_file);
+    // A failing set doesn't stop the remaining ones
+    try {
+      rc |= do_export(set_cmd, render_variables, export_format, root_file, &outputs);
+    } catch (const HardWarningException&) {
+      rc = 1;
+    } catch (const RenderBudgetException& e) {
+      LOG(message_group::Error, "%1$s", e.message());
+      rc = 1;
+    }
+  }
+  return outputs.finish() ? rc : 1;
+}
+
 int cmdline(const CommandLine& cmd)
 {
   FileFormat export_format;
@@ -609,26 +810,28 @@ int cmdline(const CommandLine& cmd)
 #endif  // ifdef ENABLE_PYTHON
   text += "\n\x03\n" + commandline_commands;
 
-  SourceFile *root_file = nullptr;
-  if (!parse(root_file, text, cmd.filename, cmd.filename, false)) {
-    delete root_file;  // parse failed
-    root_file = nullptr;
+  SourceFile *parsed_file = nullptr;
+  if (!parse(parsed_file, text, cmd.filename, cmd.filename, false)) {
+    delete parsed_file;  // parse failed
+    parsed_file = nullptr;
   }
+  // Freed once rendered, so a server doesn't keep the AST of every request
+  const std::unique_ptr<SourceFile> root_file(parsed_file);
   if (!root_file) {
     LOG("Can't parse file '%1$s'!\n", cmd.filename);
     return 1;
   }
 
   // add parameter to AST
-  CommentParser::collectParameters(text.c_str(), root_file);
+  CommentParser::collectParameters(text.c_str(), root_file.get());
   if (!cmd.parameterFile.empty() && !cmd.setName.empty()) {
-    ParameterObjects parameters = ParameterObjects::fromSourceFile(root_file);
+    ParameterObjects parameters = ParameterObjects::fromSourceFile(root_file.get());
     ParameterSets sets;
     sets.readFile(cmd.parameterFile);
     for (const auto& set : sets) {
       if (set.name() == cmd.setName) {
         parameters.importValues(set);
-        parameters.apply(root_file);
+        parameters.apply(root_file.get());
         break;
       }
     }
@@ -644,11 +847,22 @@ int cmdline(const CommandLine& cmd)
     .camera = cmd.camera,
   };
 
-  if (cmd.animate.frames == 0) {
+  if (!cmd.parameterSets.empty()) {
+    if (cmd.animate.frames != 0) {
+      LOG("--parameter-sets can't be combined with --animate.");
+      return 1;
+    }
     render_variables.time = 0;
-    return do_export(cmd, render_variables, export_format, root_file);
+    return sweep(cmd, render_variables, export_format, root_file.get());
+  } else if (cmd.animate.frames == 0) {
+    render_variables.time = 0;
+    return do_export(cmd, render_variables, export_format, root_file.get());
   } else {
-    // export the requested number of animated frames
+    // export the requested number of animated frames, writing files while the next frames render.
+    // Frames are evaluated one at a time: instantiation changes the process-wide current path
+    // and node index counter, and the caches aren't thread-safe. Use --animate_sharding with
+    // several processes to evaluate frames in parallel.
+    FrameExporter frames;
     const unsigned start_frame = ((cmd.animate.shard - 1) * cmd.animate.frames) / cmd.animate.num_shards;
     const unsigned limit_frame = (cmd.animate.shard * cmd.animate.frames) / cmd.animate.num_shards;
     for (unsigned frame = start_frame; frame < limit_frame; ++frame) {
@@ -669,14 +883,95 @@ int cmdline(const CommandLine& cmd)
       CommandLine frame_cmd = cmd;
       frame_cmd.output_file = frame_str;
 
-      int const r = do_export(frame_cmd, render_variables, export_format, root_file);
+      int const r = do_export(frame_cmd, render_variables, export_format, root_file.get(), &frames);
       if (r != 0) {
+        frames.finish();
         return r;
       }
     }
 
-    return 0;
+    return frames.finish() ? 0 : 1;
+  }
+}
+
+/*!
+   Renders requests read from in, one JSON object per line, until end of input,
+   and answers each with one JSON object per line on out. A request has the form
+
+     {"id": 1, "file": "model.scad", "D": ["size=10"], "outputs": ["model.stl"]}
+
+   where "id" is optional and returned as is, and "D" is optional and takes the
+   place of any -D options given to the server.
+
+   Each output is answered with whether it was written. Outputs aborted by
+   --max-memory or --max-time also carry an "error" message and a "budget"
+   object naming the resource, its limit and use, and the node which ran out.
+
+   Everything stays loaded between requests, so libraries, fonts and geometry
+   shared by requests are only parsed, loaded or rendered once, within the limits
+   of the caches. Requests are rendered one at a time, since evaluation relies
+   on process-wide state like the current directory.
+ */
+int serve(std::istream& in, std::ostream& out,
+          const std::function<int(const std::string&, const std::string&)>& render)
+{
+  const std::string default_commands = commandline_commands;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (boost::algorithm::trim_copy(line).empty()) continue;
+    const auto start = std::chrono::steady_clock::now();
+    nlohmann::json response;
+    try {
+      const auto request = nlohmann::json::parse(line);
+      if (request.contains("id")) response["id"] = request["id"];
+      const auto file = request.at("file").get<std::string>();
+      const auto outputs = request.at("outputs").get<std::vector<std::string>>();
+      if (file == "-" || outputs.empty() ||
+          std::find(outputs.begin(), outputs.end(), "-") != outputs.end()) {
+        throw std::invalid_argument("file and outputs must be files, stdin and stdout are reserved");
+      }
+      // Deprecations seen by an earlier request are reported again
+      resetSuppressedMessages();
+      commandline_commands = default_commands;
+      if (request.contains("D")) {
+        commandline_commands.clear();
+        for (const auto& assignment : request["D"].get<std::vector<std::string>>()) {
+          commandline_commands += assignment + ";\n";
+        }
+      }
+
+      int rc = 0;
+      nlohmann::json results = nlohmann::json::array();
+      for (const auto& output : outputs) {
+        int output_rc;
+        nlohmann::json result = {{"file", output}};
+        try {
+          output_rc = render(file, output);
+        } catch (const HardWarningException&) {
+          output_rc = 1;
+        } catch (const RenderBudgetException& e) {
+          output_rc = 1;
+          result["error"] = e.message();
+          result["budget"] = {{"resource", e.resource}, {"limit", e.limit}, {"used", e.used},
+                              {"node", e.node}, {"location", e.location}};
+        }
+        result["ok"] = output_rc == 0;
+        results.push_back(std::move(result));
+        rc |= output_rc;
+      }
+      response["ok"] = rc == 0;
+      response["outputs"] = std::move(results);
+    } catch (const std::exception& e) {
+      response["ok"] = false;
+      response["error"] = e.what();
+    }
+    response["milliseconds"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+    out << response.dump() << std::endl;
   }
+  commandline_commands = default_commands;
+  return 0;
 }
 
 template <class Seq, typename ToString>
@@ -862,6 +1157,10 @@ int openscad_main(int argc, char **argv)
     ("D,D", po::value<std::vector<std::string>>(), "var=val -pre-define variables")
     ("p,p", po::value<std::string>(), "customizer parameter file")
     ("P,P", po::value<std::string>(), "customizer parameter set")
+    ("parameter-sets", po::value<std::vector<std::string>>()->multitoken(),
+      "=set..., render each of the given customizer parameter sets of the -p file, or all of them "
+      "for 'all', reusing the parsed file and caches between sets. '{set}' in the output file name "
+      "is replaced by the set name.")
 #ifdef ENABLE_EXPERIMENTAL
     ("enable", po::value<std::vector<std::string>>(),
       ("enable experimental features (specify 'all' for enabling all available features): " +
@@ -896,9 +1195,27 @@ int openscad_main(int argc, char **argv)
     ("csglimit", po::value<unsigned int>(), "=n -stop rendering at n CSG elements when exporting png")
     ("summary", po::value<std::vector<std::string>>(),
       "enable additional render summary and statistics: all | cache | time | camera | geometry | "
-      "bounding-box | area")
+      "bounding-box | area | evaluation | memory")
     ("summary-file", po::value<std::string>(),
       "output summary information in JSON format to the given file, using '-' outputs to stdout")
+    ("server",
+      "run as a render server: read requests from stdin, one JSON object per line like "
+      "{\"file\": \"in.scad\", \"D\": [\"x=1\"], \"outputs\": [\"out.stl\"]}, and answer each with a "
+      "JSON line on stdout, keeping caches between requests")
+    ("max-memory", po::value<size_t>(),
+      "=megabytes, abort evaluation and rendering of each output when the process uses more memory, "
+      "after clearing the caches")
+    ("max-time", po::value<double>(),
+      "=seconds, abort evaluation and rendering of each output when it takes longer")
+    ("progress",
+      "print the progress of rendering and the estimated time left as lines of JSON on stderr, "
+      "prefixed with PROGRESS")
+    ("profile", po::value<std::string>(),
+      "=file, write the time spent on each node as Chrome trace-event JSON to the given file, and as "
+      "folded stacks for flamegraphs to the same file with the extension .folded")
+    ("import-cache", po::value<std::string>(),
+      "=directory, keep imported meshes and 2D shapes in the given directory and reuse them across "
+      "runs as long as file content and import parameters are unchanged")
     ("colorscheme", po::value<std::string>(),
           ("=colorscheme: " +
            str_join(ColorMap::inst()->colorSchemeNames(), " | ",
@@ -1105,6 +1422,11 @@ int openscad_main(int argc, char **argv)
     inputFiles = vm["input-file"].as<std::vector<std::string>>();
   }
 
+  if (vm.count("import-cache")) {
+    const auto dir = fs::absolute(fs::u8path(vm["import-cache"].as<std::string>()));
+    ImportCache::instance()->setPersistentPath(dir.generic_u8string());
+  }
+
   if (vm.count("colorscheme")) {
     arg_colorscheme = vm["colorscheme"].as<std::string>();
   }
@@ -1138,6 +1460,57 @@ int openscad_main(int argc, char **argv)
 
   PRINTDB("Application location detected as %s", applicationPath);
 
+  const auto export_options = convert_export_options(vm);
+  const auto summary_options =
+    vm.count("summary") ? vm["summary"].as<std::vector<std::string>>() : std::vector<std::string>{};
+  const auto summary_file = vm.count("summary-file") ? vm["summary-file"].as<std::string>() : "";
+  const auto profile_file = vm.count("profile") ? vm["profile"].as<std::string>() : "";
+  RenderBudget::Limits budget;
+  if (vm.count("max-memory")) budget.max_memory = vm["max-memory"].as<size_t>() << 20;
+  if (vm.count("max-time")) budget.max_time = vm["max-time"].as<double>();
+  const auto parameter_sets = vm.count("parameter-sets")
+                                ? vm["parameter-sets"].as<std::vector<std::string>>()
+                                : std::vector<std::string>{};
+  if (!parameter_sets.empty() && (parameterFile.empty() || !parameterSet.empty())) {
+    LOG("--parameter-sets requires -p, and replaces -P.");
+    return 1;
+  }
+  const auto render = [&](const std::string& input, const std::string& filename) {
+    const bool is_stdin = input == "-";
+    const std::string input_file = is_stdin ? "<stdin>" : input;
+    const bool is_stdout = filename == "-";
+    const std::string output_file = is_stdout ? "<stdout>" : filename;
+    const CommandLine cmd{is_stdin,
+                          input_file,
+                          is_stdout,
+                          output_file,
+                          original_path,
+                          parameterFile,
+                          parameterSet,
+                          viewOptions,
+                          camera,
+                          export_format,
+                          export_options,
+                          animate,
+                          summary_options,
+                          summary_file,
+                          profile_file,
+                          parameter_sets,
+                          budget,
+                          vm.count("progress") > 0};
+    return cmdline(cmd);
+  };
+
+  if (vm.count("server")) {
+    if (!inputFiles.empty() || !output_files.empty() || summary_file == "-") {
+      LOG("--server reads input and output files from its requests, and answers on stdout.");
+      return 1;
+    }
+    parser_init();
+    localization_init();
+    return serve(std::cin, std::cout, render);
+  }
+
   auto cmdlinemode = false;
   if (!output_files.empty()) {  // cmd-line mode
     cmdlinemode = true;
@@ -1153,31 +1526,14 @@ int openscad_main(int argc, char **argv)
         rc = info();
       } else {
         for (const auto& filename : output_files) {
-          const bool is_stdin = inputFiles[0] == "-";
-          const std::string input_file = is_stdin ? "<stdin>" : inputFiles[0];
-          const bool is_stdout = filename == "-";
-          const std::string output_file = is_stdout ? "<stdout>" : filename;
-          const auto export_options = convert_export_options(vm);
-          const CommandLine cmd{is_stdin,
-                                input_file,
-                                is_stdout,
-                                output_file,
-                                original_path,
-                                parameterFile,
-                                parameterSet,
-                                viewOptions,
-                                camera,
-                                export_format,
-                                export_options,
-                                animate,
-                                vm.count("summary") ? vm["summary"].as<std::vector<std::string>>()
-                                                    : std::vector<std::string>{},
-                                vm.count("summary-file") ? vm["summary-file"].as<std::string>() : ""};
-          rc |= cmdline(cmd);
+          rc |= render(inputFiles[0], filename);
         }
       }
     } catch (const HardWarningException&) {
       rc = 1;
+    } catch (const RenderBudgetException& e) {
+      LOG(message_group::Error, "%1$s", e.message());
+      rc = 1;
     }
 
     if (deps_output_file) {
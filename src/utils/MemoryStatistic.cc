@@ -0,0 +1,142 @@
+#include "utils/MemoryStatistic.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#ifdef USE_MIMALLOC
+#include <mimalloc.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fstream>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+#endif
+
+namespace {
+
+struct Counter {
+  std::atomic<size_t> live{0};
+  std::atomic<size_t> peak{0};
+
+  void add(size_t bytes)
+  {
+    const size_t now = live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t highest = peak.load(std::memory_order_relaxed);
+    while (now > highest && !peak.compare_exchange_weak(highest, now, std::memory_order_relaxed)) {
+    }
+  }
+  void remove(size_t bytes) { live.fetch_sub(bytes, std::memory_order_relaxed); }
+  [[nodiscard]] MemoryStatistic::Usage usage() const
+  {
+    return {live.load(std::memory_order_relaxed), peak.load(std::memory_order_relaxed)};
+  }
+};
+
+std::array<Counter, MemoryStatistic::NUM_CATEGORIES> counters;
+Counter sum;
+std::atomic<bool> geometryTracking{false};
+
+}  // namespace
+
+void MemoryStatistic::add(Category category, size_t bytes)
+{
+  if (bytes == 0) return;
+  counters[static_cast<size_t>(category)].add(bytes);
+  if (category != Category::Caches) sum.add(bytes);
+}
+
+void MemoryStatistic::remove(Category category, size_t bytes)
+{
+  if (bytes == 0) return;
+  counters[static_cast<size_t>(category)].remove(bytes);
+  if (category != Category::Caches) sum.remove(bytes);
+}
+
+const char *MemoryStatistic::name(Category category)
+{
+  switch (category) {
+  case Category::Values:         return "values";
+  case Category::NodeTree:       return "node_tree";
+  case Category::PolySets:       return "polysets";
+  case Category::NefPolyhedra:   return "nef_polyhedra";
+  case Category::ManifoldMeshes: return "manifold_meshes";
+  case Category::Caches:         return "caches";
+  }
+  return "unknown";
+}
+
+MemoryStatistic::Usage MemoryStatistic::usage(Category category)
+{
+  return counters[static_cast<size_t>(category)].usage();
+}
+
+MemoryStatistic::Usage MemoryStatistic::total()
+{
+  return sum.usage();
+}
+
+MemoryStatistic::Usage MemoryStatistic::process()
+{
+  Usage usage;
+#ifdef USE_MIMALLOC
+  mi_process_info(nullptr, nullptr, nullptr, &usage.live, &usage.peak, nullptr, nullptr, nullptr);
+#elif defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS info;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info))) {
+    usage.live = info.WorkingSetSize;
+    usage.peak = info.PeakWorkingSetSize;
+  }
+#else
+  struct rusage rusage;
+  if (getrusage(RUSAGE_SELF, &rusage) == 0) {
+#ifdef __APPLE__
+    usage.peak = rusage.ru_maxrss;  // bytes
+#else
+    usage.peak = static_cast<size_t>(rusage.ru_maxrss) * 1024;  // kilobytes
+#endif
+  }
+#ifdef __APPLE__
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+      KERN_SUCCESS) {
+    usage.live = info.resident_size;
+  }
+#else
+  // Second field of statm is the resident set size in pages (Linux only)
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0;
+  if (statm >> pages >> pages) usage.live = pages * sysconf(_SC_PAGESIZE);
+#endif
+#endif
+  return usage;
+}
+
+void MemoryStatistic::trackGeometry(bool enable)
+{
+  geometryTracking.store(enable, std::memory_order_relaxed);
+}
+
+bool MemoryStatistic::tracksGeometry()
+{
+  return geometryTracking.load(std::memory_order_relaxed);
+}
+
+MemoryStatistic::Tracked::~Tracked()
+{
+  remove(this->category, this->bytes);
+}
+
+void MemoryStatistic::Tracked::update(Category category, size_t bytes)
+{
+  remove(this->category, this->bytes);
+  this->category = category;
+  this->bytes = bytes;
+  add(category, bytes);
+}
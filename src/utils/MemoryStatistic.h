@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+
+/*!
+   Attributes memory to the subsystems holding it, keeping the live and peak bytes
+   of each.
+
+   The bytes are estimates reported by the subsystems themselves, e.g. the memsize()
+   of geometry or the costs of cache entries, not measured allocations. Computing the
+   memsize() of some geometry means traversing it, so geometry results are only counted
+   while trackGeometry() is enabled, as for --summary memory. The entries of caches
+   hold geometry which is also counted in its own category, so Caches is not part of
+   total(). The process figures are measured, from the allocator or the operating
+   system.
+ */
+class MemoryStatistic
+{
+public:
+  enum class Category {
+    Values,          // Evaluator values and contexts
+    NodeTree,        // Nodes of the instantiated tree
+    PolySets,        // Meshes of PolySet results
+    NefPolyhedra,    // CGAL Nef polyhedra results
+    ManifoldMeshes,  // Manifold results
+    Caches,          // Entries of the geometry, CGAL and import caches, not part of total()
+  };
+  static constexpr size_t NUM_CATEGORIES = 6;
+
+  struct Usage {
+    size_t live = 0;
+    size_t peak = 0;
+  };
+
+  static void add(Category category, size_t bytes);
+  static void remove(Category category, size_t bytes);
+
+  // The name of category as used in summaries, e.g. "node_tree"
+  [[nodiscard]] static const char *name(Category category);
+  [[nodiscard]] static Usage usage(Category category);
+  // The sum over all categories but Caches; its peak is that of the sum, not the sum of peaks
+  [[nodiscard]] static Usage total();
+  // Resident set size of the process, or zeros if not available on this platform. Available
+  // with mimalloc, and otherwise on Linux, macOS and Windows.
+  [[nodiscard]] static Usage process();
+
+  // Enables counting geometry results in their categories, see Geometry::trackMemory()
+  static void trackGeometry(bool enable);
+  [[nodiscard]] static bool tracksGeometry();
+
+  /*!
+     Bytes of one object, accounted while the object is alive.
+
+     Copies start out accounting nothing, as the bytes of a copy are only known to
+     its owner.
+   */
+  class Tracked
+  {
+  public:
+    Tracked() = default;
+    Tracked(Category category, size_t bytes) { update(category, bytes); }
+    Tracked(const Tracked& /*other*/) {}
+    Tracked& operator=(const Tracked& /*other*/) { return *this; }
+    ~Tracked();
+
+    // Replaces the accounted bytes
+    void update(Category category, size_t bytes);
+    [[nodiscard]] size_t size() const { return bytes; }
+
+  private:
+    Category category = Category::Values;
+    size_t bytes = 0;
+  };
+};
@@ -0,0 +1,58 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Cache.h"
+#include "geometry/CacheStatistic.h"
+
+TEST_CASE("Cache counts evictions and lists entries by recent use", "[Cache]")
+{
+  Cache<std::string, int> cache(10);
+  CHECK(cache.insert("a", new int(1), 4));
+  CHECK(cache.insert("b", new int(2), 4));
+  CHECK(*cache["a"] == 1);  // a becomes the most recently used
+
+  std::vector<std::string> keys;
+  cache.forEach([&](const std::string& key, const int& /*object*/, size_t cost) {
+    keys.push_back(key);
+    CHECK(cost == 4);
+  });
+  const std::vector<std::string> expected = {"a", "b"};
+  CHECK(keys == expected);
+  CHECK(cache.evictions() == 0);
+
+  CHECK(cache.insert("c", new int(3), 4));
+  CHECK(!cache.contains("b"));
+  CHECK(cache.evictions() == 1);
+
+  // Removing and clearing isn't evicting
+  cache.remove("a");
+  cache.clear();
+  CHECK(cache.evictions() == 1);
+}
+
+TEST_CASE("CacheStatistic summarizes hits and entries", "[Cache]")
+{
+  CacheStatistic statistic;
+  statistic.miss("union");
+  statistic.hit("union");
+  statistic.hit("union");
+  statistic.miss("cube");
+  CHECK(statistic.total.hits == 2);
+  CHECK(statistic.total.hitRatio() == Catch::Approx(0.5));
+  CHECK(statistic.byNodeType["union"].hitRatio() == Catch::Approx(2.0 / 3.0));
+  CHECK(statistic.byNodeType["cube"].hitRatio() == 0);
+
+  const auto now = std::chrono::steady_clock::now();
+  CacheEntryInfo recent;
+  recent.geometryType = "polyset";
+  recent.inserted = now;
+  CacheEntryInfo old;
+  old.geometryType = "polyset";
+  old.inserted = now - std::chrono::hours(2);
+  statistic.addEntry(recent, 100, now);
+  statistic.addEntry(old, 50, now);
+  CHECK(statistic.bytesByGeometryType["polyset"] == 150);
+  CHECK(statistic.entriesByAge.front() == 1);
+  CHECK(statistic.entriesByAge.back() == 1);
+}
@@ -0,0 +1,170 @@
+#include <catch2/catch_all.hpp>
+#include "src/geometry/ConvexHull.h"
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "src/geometry/linalg.h"
+#include "src/geometry/PolySet.h"
+
+namespace {
+
+std::vector<Vector3d> sphere(const Vector3d& center, double r, int n)
+{
+  // Fibonacci sphere, so all points are hull vertices
+  std::vector<Vector3d> points;
+  const double golden = M_PI * (3 - std::sqrt(5.0));
+  for (int i = 0; i < n; ++i) {
+    const double z = 1 - 2 * (i + 0.5) / n;
+    const double rxy = std::sqrt(1 - z * z);
+    const Vector3d direction(rxy * std::cos(golden * i), rxy * std::sin(golden * i), z);
+    points.emplace_back(center + r * direction);
+  }
+  return points;
+}
+
+double volume(const PolySet& ps)
+{
+  double v = 0;
+  for (const auto& face : ps.indices) {
+    v += ps.vertices[face[0]].dot(ps.vertices[face[1]].cross(ps.vertices[face[2]])) / 6;
+  }
+  return v;
+}
+
+// Checks that every edge is shared by exactly one other face in the opposite direction,
+// and that no point lies above any face
+void checkHull(const PolySet& ps, const std::vector<Vector3d>& points)
+{
+  std::map<std::pair<int, int>, int> edges;
+  for (const auto& face : ps.indices) {
+    REQUIRE(face.size() == 3);
+    for (size_t i = 0; i < 3; ++i) edges[{face[i], face[(i + 1) % 3]}]++;
+  }
+  for (const auto& [edge, count] : edges) {
+    REQUIRE(count == 1);
+    REQUIRE(edges.count({edge.second, edge.first}) == 1);
+  }
+  size_t above = 0;
+  for (const auto& face : ps.indices) {
+    const auto& a = ps.vertices[face[0]];
+    const Vector3d normal = (ps.vertices[face[1]] - a).cross(ps.vertices[face[2]] - a).normalized();
+    for (const auto& p : points) above += normal.dot(p - a) > 1e-9;
+  }
+  CHECK(above == 0);
+}
+
+}  // namespace
+
+TEST_CASE("hull2d drops interior and collinear points", "[convex_hull]")
+{
+  const auto hull = ConvexHull::hull2d({{1, 1}, {0, 0}, {2, 0}, {1, 0}, {2, 2}, {0, 2}, {0, 2}, {1, 2}});
+  const VectorOfVector2d expected = {{0, 0}, {2, 0}, {2, 2}, {0, 2}};
+  REQUIRE(hull == expected);
+}
+
+TEST_CASE("hull2d keeps degenerate input", "[convex_hull]")
+{
+  REQUIRE(ConvexHull::hull2d({{1, 1}, {1, 1}}).size() == 1);
+  REQUIRE(ConvexHull::hull2d({{0, 0}, {1, 1}, {2, 2}}).size() == 2);
+}
+
+TEST_CASE("hull2d of a large point cloud", "[convex_hull]")
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+  std::uniform_real_distribution<double> radius(0, 1);
+  VectorOfVector2d points;
+  for (int i = 0; i < 100000; ++i) {
+    const double a = angle(rng);
+    const double r = std::sqrt(radius(rng));
+    points.emplace_back(r * std::cos(a), r * std::sin(a));
+  }
+  const auto hull = ConvexHull::hull2d(points);
+  REQUIRE(hull.size() >= 3);
+  size_t outside = 0;
+  for (size_t i = 0; i < hull.size(); ++i) {
+    const auto& a = hull[i];
+    const auto& b = hull[(i + 1) % hull.size()];
+    for (const auto& p : points) {
+      outside += (b[0] - a[0]) * (p[1] - a[1]) - (b[1] - a[1]) * (p[0] - a[0]) < -1e-12;
+    }
+  }
+  CHECK(outside == 0);
+}
+
+TEST_CASE("hull3d of a cube with interior points", "[convex_hull]")
+{
+  std::vector<Vector3d> points;
+  for (int i = 0; i < 8; ++i) points.emplace_back(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1);
+  // Interior, face and edge points, and duplicates
+  points.emplace_back(0, 0, 0);
+  points.emplace_back(0.5, -0.25, 1);
+  points.emplace_back(1, 1, 0);
+  points.emplace_back(1, 1, 1);
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> coord(-0.99, 0.99);
+  for (int i = 0; i < 1000; ++i) points.emplace_back(coord(rng), coord(rng), coord(rng));
+
+  const auto ps = ConvexHull::hull3d(points);
+  REQUIRE(ps);
+  CHECK(ps->isConvex());
+  CHECK(ps->isTriangular());
+  CHECK(ps->vertices.size() == 8);
+  CHECK(ps->indices.size() == 12);
+  CHECK(volume(*ps) == Catch::Approx(8));
+  checkHull(*ps, points);
+}
+
+TEST_CASE("hull3d of spheres", "[convex_hull]")
+{
+  auto points = sphere(Vector3d::Zero(), 10, 20000);
+  auto ps = ConvexHull::hull3d(points);
+  REQUIRE(ps);
+  CHECK(ps->vertices.size() == points.size());
+  CHECK(ps->indices.size() == 2 * points.size() - 4);
+  checkHull(*ps, points);
+
+  // A rounded box: only the outward facing parts of the corner spheres are on the hull
+  points.clear();
+  for (int i = 0; i < 8; ++i) {
+    const Vector3d corner(i & 1 ? 20 : -20, i & 2 ? 10 : -10, i & 4 ? 5 : -5);
+    const auto s = sphere(corner, 2, 2000);
+    points.insert(points.end(), s.begin(), s.end());
+  }
+  ps = ConvexHull::hull3d(points);
+  REQUIRE(ps);
+  CHECK(ps->vertices.size() < points.size() / 2);
+  // Steiner formula for a 40x20x10 box grown by 2
+  const double expected = 40 * 20 * 10 + 2 * (40 * 20 + 20 * 10 + 10 * 40) * 2 +
+                          M_PI / 4 * 4 * (40 + 20 + 10) * 4 + 4.0 / 3 * M_PI * 8;
+  CHECK(volume(*ps) == Catch::Approx(expected).epsilon(0.01));
+  checkHull(*ps, points);
+}
+
+TEST_CASE("hull3d of degenerate input", "[convex_hull]")
+{
+  CHECK_FALSE(ConvexHull::hull3d({{0, 0, 0}, {1, 0, 0}, {0, 1, 0}}));
+  CHECK_FALSE(ConvexHull::hull3d({{0, 0, 0}, {1, 1, 1}, {2, 2, 2}, {3, 3, 3}}));
+
+  const auto ps = ConvexHull::hull3d({{0, 0, 1}, {2, 0, 1}, {2, 2, 1}, {0, 2, 1}, {1, 1, 1}});
+  REQUIRE(ps);
+  REQUIRE(ps->indices.size() == 1);
+  CHECK(ps->indices[0].size() == 4);
+}
+
+TEST_CASE("hull3d benchmark", "[.][benchmark]")
+{
+  // Hull of a grid of high resolution spheres, as in hull() based rounded boxes
+  std::vector<Vector3d> points;
+  for (int i = 0; i < 64; ++i) {
+    const auto s = sphere(Vector3d(i % 4 * 10, i / 4 % 4 * 10, i / 16 * 10), 3, 16384);
+    points.insert(points.end(), s.begin(), s.end());
+  }
+  BENCHMARK("hull3d of 64 spheres of 16k points") { return ConvexHull::hull3d(points); };
+}
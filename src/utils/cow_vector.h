@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*!
+   Statistics shared by all CowVector instantiations.
+
+   bytesShared() is the number of bytes copies of CowVectors currently avoid
+   copying: for each storage held by more than one CowVector, its size times the
+   number of holders beyond the first. A share is given up when a holder is
+   modified, reassigned, cleared or destroyed.
+ */
+class CowStatistic
+{
+public:
+  static size_t bytesShared() { return bytes_shared.load(std::memory_order_relaxed); }
+
+  static void shared(size_t bytes) { bytes_shared.fetch_add(bytes, std::memory_order_relaxed); }
+  static void unshared(size_t bytes) { bytes_shared.fetch_sub(bytes, std::memory_order_relaxed); }
+
+private:
+  static inline std::atomic<size_t> bytes_shared{0};
+};
+
+/*!
+   A std::vector whose storage is shared between copies until one of them is modified.
+
+   Copying is O(1). Const access never copies, while any non-const access
+   (including non-const begin() and operator[]) first makes this instance the
+   sole owner of its storage, copying it if it is shared.
+
+   Each non-const access checks whether the storage is shared, so loops writing
+   elements should take the vector from mut() once instead. As with any
+   copy-on-write container, references and iterators obtained through non-const
+   access must not be kept across copying the container.
+
+   Converts implicitly to const std::vector<T>&, so it can be passed to code
+   reading plain vectors. Converting an rvalue, e.g. std::move(ps->vertices),
+   moves the storage out unless it is shared.
+ */
+template <typename T>
+class CowVector
+{
+public:
+  using vector_type = std::vector<T>;
+  using value_type = T;
+  using size_type = typename vector_type::size_type;
+  using difference_type = typename vector_type::difference_type;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = typename vector_type::iterator;
+  using const_iterator = typename vector_type::const_iterator;
+
+  CowVector() = default;
+  CowVector(const CowVector& other) : data_(other.data_) { CowStatistic::shared(bytes()); }
+  CowVector(CowVector&& other) noexcept = default;
+  ~CowVector() { release(); }
+  CowVector(vector_type v) : data_(std::make_shared<vector_type>(std::move(v))) {}
+  CowVector(std::initializer_list<T> init) : data_(std::make_shared<vector_type>(init)) {}
+  explicit CowVector(size_type count, const T& value = T())
+    : data_(std::make_shared<vector_type>(count, value))
+  {
+  }
+  template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  CowVector(InputIt first, InputIt last) : data_(std::make_shared<vector_type>(first, last))
+  {
+  }
+
+  CowVector& operator=(const CowVector& other)
+  {
+    if (data_ != other.data_) {
+      release();
+      data_ = other.data_;
+      CowStatistic::shared(bytes());
+    }
+    return *this;
+  }
+  CowVector& operator=(CowVector&& other) noexcept
+  {
+    if (this != &other) {
+      release();
+      data_ = std::move(other.data_);
+    }
+    return *this;
+  }
+  CowVector& operator=(vector_type v)
+  {
+    release();
+    data_ = std::make_shared<vector_type>(std::move(v));
+    return *this;
+  }
+  CowVector& operator=(std::initializer_list<T> init)
+  {
+    release();
+    data_ = std::make_shared<vector_type>(init);
+    return *this;
+  }
+
+  // Read access
+  operator const vector_type&() const& { return get(); }
+  operator vector_type() && { return take(); }
+  [[nodiscard]] const vector_type& get() const { return data_ ? *data_ : empty_vector(); }
+  [[nodiscard]] size_type size() const { return get().size(); }
+  [[nodiscard]] bool empty() const { return get().empty(); }
+  [[nodiscard]] size_type capacity() const { return get().capacity(); }
+  const_reference operator[](size_type i) const { return get()[i]; }
+  const_reference at(size_type i) const { return get().at(i); }
+  const_reference front() const { return get().front(); }
+  const_reference back() const { return get().back(); }
+  const T *data() const { return get().data(); }
+  const_iterator begin() const { return get().begin(); }
+  const_iterator end() const { return get().end(); }
+  const_iterator cbegin() const { return get().cbegin(); }
+  const_iterator cend() const { return get().cend(); }
+
+  // Returns true if the storage is shared with another CowVector
+  [[nodiscard]] bool isShared() const { return data_ && data_.use_count() > 1; }
+
+  // Write access, copying shared storage first
+  vector_type& mut()
+  {
+    if (!data_) {
+      data_ = std::make_shared<vector_type>();
+    } else if (data_.use_count() > 1) {
+      auto copy = std::make_shared<vector_type>(*data_);
+      CowStatistic::unshared(bytes());
+      data_ = std::move(copy);
+    }
+    return *data_;
+  }
+  // Leaves this empty, moving the storage out if it isn't shared, else copying it
+  vector_type take()
+  {
+    if (!data_) return {};
+    vector_type v;
+    if (data_.use_count() > 1) v = *data_;
+    else v = std::move(*data_);
+    release();
+    return v;
+  }
+
+  reference operator[](size_type i) { return mut()[i]; }
+  reference at(size_type i) { return mut().at(i); }
+  reference front() { return mut().front(); }
+  reference back() { return mut().back(); }
+  T *data() { return mut().data(); }
+  iterator begin() { return mut().begin(); }
+  iterator end() { return mut().end(); }
+
+  void push_back(const T& value) { mut().push_back(value); }
+  void push_back(T&& value) { mut().push_back(std::move(value)); }
+  template <typename... Args>
+  reference emplace_back(Args&&...args)
+  {
+    return mut().emplace_back(std::forward<Args>(args)...);
+  }
+  void pop_back() { mut().pop_back(); }
+  void reserve(size_type n) { mut().reserve(n); }
+  void resize(size_type n) { mut().resize(n); }
+  void resize(size_type n, const T& value) { mut().resize(n, value); }
+  void assign(size_type n, const T& value) { mut().assign(n, value); }
+  void clear()
+  {
+    // No need to copy what is about to be discarded
+    if (isShared()) release();
+    else if (data_) data_->clear();
+  }
+  template <typename... Args>
+  iterator insert(const_iterator pos, Args&&...args)
+  {
+    const auto offset = pos - get().cbegin();
+    auto& v = mut();
+    return v.insert(v.begin() + offset, std::forward<Args>(args)...);
+  }
+  iterator erase(const_iterator pos)
+  {
+    const auto offset = pos - get().cbegin();
+    auto& v = mut();
+    return v.erase(v.begin() + offset);
+  }
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    const auto offset = first - get().cbegin();
+    const auto count = last - first;
+    auto& v = mut();
+    return v.erase(v.begin() + offset, v.begin() + offset + count);
+  }
+
+  bool operator==(const CowVector& other) const { return data_ == other.data_ || get() == other.get(); }
+  bool operator!=(const CowVector& other) const { return !(*this == other); }
+
+private:
+  size_t bytes() const { return data_ ? data_->size() * sizeof(T) : 0; }
+  // Drops this holder of the storage, giving up its share
+  void release()
+  {
+    if (data_.use_count() > 1) CowStatistic::unshared(bytes());
+    data_.reset();
+  }
+  static const vector_type& empty_vector()
+  {
+    static const vector_type empty;
+    return empty;
+  }
+
+  std::shared_ptr<vector_type> data_;
+};
@@ -0,0 +1,88 @@
+#include <catch2/catch_all.hpp>
+#include <utility>
+#include <vector>
+#include "cow_vector.h"
+
+TEST_CASE("CowVector shares storage until modified", "[CowVector]")
+{
+  CowVector<int> a{1, 2, 3};
+  const size_t shared_before = CowStatistic::bytesShared();
+
+  CowVector<int> b = a;
+  CHECK(a.isShared());
+  CHECK(std::as_const(b).data() == std::as_const(a).data());
+  CHECK(CowStatistic::bytesShared() == shared_before + 3 * sizeof(int));
+
+  b.push_back(4);
+  CHECK_FALSE(a.isShared());
+  CHECK(CowStatistic::bytesShared() == shared_before);
+  CHECK(a.get() == std::vector<int>{1, 2, 3});
+  CHECK(b.get() == std::vector<int>{1, 2, 3, 4});
+}
+
+TEST_CASE("CowVector gives up shares of released storage", "[CowVector]")
+{
+  CowVector<int> a{1, 2, 3};
+  const size_t shared_before = CowStatistic::bytesShared();
+  {
+    CowVector<int> b = a;
+    CHECK(CowStatistic::bytesShared() == shared_before + 3 * sizeof(int));
+  }
+  CHECK(CowStatistic::bytesShared() == shared_before);
+
+  CowVector<int> c = a;
+  c.clear();
+  CHECK(CowStatistic::bytesShared() == shared_before);
+
+  CowVector<int> d = a;
+  d = CowVector<int>{4};
+  CHECK(CowStatistic::bytesShared() == shared_before);
+  d = a;
+  d = std::vector<int>{5};
+  CHECK(CowStatistic::bytesShared() == shared_before);
+  CHECK_FALSE(a.isShared());
+}
+
+TEST_CASE("CowVector non-const access detaches", "[CowVector]")
+{
+  CowVector<int> a{1, 2, 3};
+  CowVector<int> b = a;
+  for (auto& v : b) v *= 2;
+  CHECK(a.get() == std::vector<int>{1, 2, 3});
+  CHECK(b.get() == std::vector<int>{2, 4, 6});
+
+  CowVector<int> c = a;
+  c.erase(c.begin());
+  c.insert(c.end(), 7);
+  CHECK(a.get() == std::vector<int>{1, 2, 3});
+  CHECK(c.get() == std::vector<int>{2, 3, 7});
+
+  CowVector<int> d = a;
+  d.clear();
+  CHECK(d.empty());
+  CHECK(a.size() == 3);
+}
+
+TEST_CASE("CowVector moves out unshared storage", "[CowVector]")
+{
+  CowVector<int> a{1, 2, 3};
+  const int *storage = std::as_const(a).data();
+  std::vector<int> moved = std::move(a);
+  CHECK(moved.data() == storage);
+  CHECK(a.empty());
+
+  CowVector<int> b{4, 5};
+  CowVector<int> c = b;
+  const size_t shared_before = CowStatistic::bytesShared();
+  std::vector<int> taken = c.take();
+  CHECK(taken == std::vector<int>{4, 5});
+  CHECK(c.empty());
+  CHECK_FALSE(b.isShared());
+  CHECK(b.get() == std::vector<int>{4, 5});
+  CHECK(CowStatistic::bytesShared() == shared_before - 2 * sizeof(int));
+
+  const CowVector<int> empty;
+  CHECK(empty.size() == 0);
+  CHECK(empty.begin() == empty.end());
+  CHECK(CowVector<int>().take().empty());
+}
@@ -0,0 +1,126 @@
+#include <catch2/catch_all.hpp>
+#include "src/geometry/Grid.h"
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+// The original std::map based snapping, kept as reference for the semantics of Grid2d
+struct ReferenceGrid2d {
+  double res;
+  std::map<std::pair<int64_t, int64_t>, int> db;
+
+  int align(double& x, double& y)
+  {
+    auto ix = (int64_t)std::round(x / res);
+    auto iy = (int64_t)std::round(y / res);
+    if (db.find(std::make_pair(ix, iy)) == db.end()) {
+      int dist = 10;
+      for (int64_t jx = ix - 1; jx <= ix + 1; ++jx) {
+        for (int64_t jy = iy - 1; jy <= iy + 1; ++jy) {
+          if (db.find(std::make_pair(jx, jy)) == db.end()) continue;
+          int d = abs(int(ix - jx)) + abs(int(iy - jy));
+          if (d < dist) {
+            dist = d;
+            ix = jx;
+            iy = jy;
+          }
+        }
+      }
+    }
+    x = ix * res, y = iy * res;
+    return db.emplace(std::make_pair(ix, iy), db.size()).first->second;
+  }
+};
+
+// The original std::map based snapping, kept as reference for the semantics of Grid3d
+struct ReferenceGrid3d {
+  double res;
+  std::map<std::array<int64_t, 3>, unsigned int> db;
+
+  unsigned int align(Vector3d& v)
+  {
+    std::array<int64_t, 3> key{int64_t(v[0] / res), int64_t(v[1] / res), int64_t(v[2] / res)};
+    auto iter = db.find(key);
+    if (iter == db.end()) {
+      float dist = 10.0f;
+      for (int64_t jx = key[0] - 1; jx <= key[0] + 1; ++jx) {
+        for (int64_t jy = key[1] - 1; jy <= key[1] + 1; ++jy) {
+          for (int64_t jz = key[2] - 1; jz <= key[2] + 1; ++jz) {
+            auto tmpiter = db.find({jx, jy, jz});
+            if (tmpiter == db.end()) continue;
+            const int64_t dx = key[0] - jx, dy = key[1] - jy, dz = key[2] - jz;
+            float d = sqrt(dx * dx + dy * dy + dz * dz);
+            if (d < dist) {
+              dist = d;
+              iter = tmpiter;
+            }
+          }
+        }
+      }
+    }
+    if (iter == db.end()) iter = db.emplace(key, db.size()).first;
+    v = Vector3d(iter->first[0] * res, iter->first[1] * res, iter->first[2] * res);
+    return iter->second;
+  }
+};
+
+// Points clustered within a few grid cells of each other, so that snapping to neighbors happens
+std::vector<Vector3d> clusteredPoints(size_t count, double res)
+{
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> center(-1000, 1000);
+  std::uniform_real_distribution<double> jitter(-2 * res, 2 * res);
+  std::vector<Vector3d> points;
+  points.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const Vector3d c(center(rng) * 8 * res, center(rng) * 8 * res, center(rng) * 8 * res);
+    points.emplace_back(c + Vector3d(jitter(rng), jitter(rng), jitter(rng)));
+  }
+  return points;
+}
+
+}  // namespace
+
+TEST_CASE("Grid2d snaps like the reference implementation", "[Geometry][Grid]")
+{
+  Grid2d<int> grid(GRID_COARSE);
+  ReferenceGrid2d reference{GRID_COARSE, {}};
+  int next = 0;
+  for (const auto& p : clusteredPoints(20000, GRID_COARSE)) {
+    double x1 = p[0], y1 = p[1], x2 = p[0], y2 = p[1];
+    int& data = grid.align(x1, y1);
+    if (data == 0) data = ++next;
+    reference.align(x2, y2);
+    REQUIRE(x1 == x2);
+    REQUIRE(y1 == y2);
+  }
+  CHECK(grid.size() == reference.db.size());
+}
+
+TEST_CASE("Grid3d snaps like the reference implementation", "[Geometry][Grid]")
+{
+  Grid3d<unsigned int> grid(GRID_FINE);
+  ReferenceGrid3d reference{GRID_FINE, {}};
+  for (const auto& p : clusteredPoints(20000, GRID_FINE)) {
+    Vector3d v1 = p, v2 = p;
+    REQUIRE(grid.align(v1) == reference.align(v2));
+    REQUIRE(v1 == v2);
+  }
+  CHECK(grid.size() == reference.db.size());
+}
+
+TEST_CASE("Grid3d alignment of 1M points", "[.][benchmark][Grid]")
+{
+  const auto points = clusteredPoints(1000000, GRID_FINE);
+  BENCHMARK("Grid3d alignment of 1M points")
+  {
+    Grid3d<unsigned int> grid(GRID_FINE);
+    for (auto v : points) grid.align(v);
+    return grid.size();
+  };
+}
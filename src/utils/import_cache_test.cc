@@ -0,0 +1,144 @@
+#include <catch2/catch_all.hpp>
+#include "io/ImportCache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/CurveDiscretizer.h"
+#include "core/ImportNode.h"
+#include "geometry/PolySet.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A directory of its own, as test cases may run in parallel processes
+fs::path uniqueDirectory()
+{
+  static int count = 0;
+  const auto name = "openscad_import_cache_test_" + std::to_string(std::random_device{}()) + "_" +
+                    std::to_string(count++);
+  return fs::temp_directory_path() / name;
+}
+
+// A scratch directory with an import file and a persistent cache, removed when done
+struct Scratch {
+  Scratch() : dir(uniqueDirectory())
+  {
+    fs::create_directories(dir);
+    std::ofstream(dir / "model.off") << "OFF\n3 1 0\n0 0 0\n1 0 0\n0 1 0\n3 0 1 2\n";
+    node.filename = (dir / "model.off").generic_string();
+    node.convexity = 1;
+    node.center = false;
+    node.dpi = ImportNode::SVG_DEFAULT_DPI;
+    node.origin_x = node.origin_y = 0;
+    node.scale = 1;
+  }
+  ~Scratch() { fs::remove_all(dir); }
+
+  // The single entry file of the persistent cache
+  fs::path entry() const
+  {
+    for (const auto& file : fs::directory_iterator(dir / "cache")) return file.path();
+    return {};
+  }
+
+  fs::path dir;
+  ImportNode node{nullptr, ImportType::OFF, CurveDiscretizer(16.0)};
+};
+
+std::shared_ptr<const PolySet> triangle()
+{
+  auto ps = std::make_shared<PolySet>(3);
+  ps->vertices = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+  ps->indices = {{0, 1, 2}};
+  ps->colors = {Color4f(1.0f, 0.0f, 0.0f, 1.0f)};
+  ps->color_indices = {0};
+  return ps;
+}
+
+// Loads the entry of scratch.node with a fresh cache, as a later run would
+std::shared_ptr<const Geometry> loadFresh(Scratch& scratch)
+{
+  ImportCache cache;
+  cache.setPersistentPath((scratch.dir / "cache").generic_string());
+  const auto key = cache.getKey(scratch.node);
+  REQUIRE(!key.empty());
+  return cache.get(key);
+}
+
+}  // namespace
+
+TEST_CASE("ImportCache persists PolySets across instances", "[ImportCache]")
+{
+  Scratch scratch;
+  {
+    ImportCache cache;
+    cache.setPersistentPath((scratch.dir / "cache").generic_string());
+    const auto key = cache.getKey(scratch.node);
+    REQUIRE(!key.empty());
+    CHECK(cache.insert(key, triangle()));
+  }
+
+  const auto ps = std::dynamic_pointer_cast<const PolySet>(loadFresh(scratch));
+  REQUIRE(ps);
+  const auto expected = triangle();
+  CHECK(ps->vertices.get() == expected->vertices.get());
+  CHECK(ps->indices.get() == expected->indices.get());
+  CHECK(ps->color_indices.get() == expected->color_indices.get());
+  CHECK(ps->colors.size() == 1);
+}
+
+TEST_CASE("ImportCache rejects corrupt persistent entries", "[ImportCache]")
+{
+  Scratch scratch;
+  {
+    ImportCache cache;
+    cache.setPersistentPath((scratch.dir / "cache").generic_string());
+    cache.insert(cache.getKey(scratch.node), triangle());
+  }
+  const auto file = scratch.entry();
+  REQUIRE(!file.empty());
+  std::vector<char> bytes;
+  {
+    std::ifstream in(file, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  const auto write = [&](const std::vector<char>& content) {
+    std::ofstream(file, std::ios::binary | std::ios::trunc).write(content.data(), content.size());
+  };
+
+  SECTION("truncated")
+  {
+    write(std::vector<char>(bytes.begin(), bytes.begin() + bytes.size() / 2));
+    CHECK(!loadFresh(scratch));
+  }
+
+  SECTION("huge vertex count")
+  {
+    // magic, version, key size and key, then type, dimension, convexity and two flags
+    uint64_t keySize;
+    std::copy_n(bytes.begin() + 8, sizeof(keySize), reinterpret_cast<char *>(&keySize));
+    const size_t countOffset = 16 + keySize + 1 + 4 + 4 + 1 + 1;
+    REQUIRE(countOffset + 8 <= bytes.size());
+    auto corrupt = bytes;
+    std::fill_n(corrupt.begin() + countOffset, 8, '\xff');
+    write(corrupt);
+    CHECK(!loadFresh(scratch));
+  }
+
+  SECTION("huge key size")
+  {
+    auto corrupt = bytes;
+    std::fill_n(corrupt.begin() + 8, 8, '\x7f');
+    write(corrupt);
+    CHECK(!loadFresh(scratch));
+  }
+}
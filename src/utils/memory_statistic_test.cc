@@ -0,0 +1,42 @@
+#include <catch2/catch_all.hpp>
+#include "MemoryStatistic.h"
+
+using Category = MemoryStatistic::Category;
+
+TEST_CASE("MemoryStatistic tracks live and peak bytes of objects", "[MemoryStatistic]")
+{
+  const auto before = MemoryStatistic::usage(Category::PolySets);
+  {
+    MemoryStatistic::Tracked a(Category::PolySets, 1000);
+    {
+      MemoryStatistic::Tracked b(Category::PolySets, 500);
+      CHECK(MemoryStatistic::usage(Category::PolySets).live == before.live + 1500);
+    }
+    CHECK(MemoryStatistic::usage(Category::PolySets).live == before.live + 1000);
+    CHECK(MemoryStatistic::usage(Category::PolySets).peak >= before.live + 1500);
+
+    a.update(Category::PolySets, 200);
+    CHECK(MemoryStatistic::usage(Category::PolySets).live == before.live + 200);
+  }
+  CHECK(MemoryStatistic::usage(Category::PolySets).live == before.live);
+}
+
+TEST_CASE("MemoryStatistic does not account copies of tracked objects", "[MemoryStatistic]")
+{
+  const auto before = MemoryStatistic::usage(Category::NodeTree);
+  MemoryStatistic::Tracked a(Category::NodeTree, 100);
+  const MemoryStatistic::Tracked copy = a;
+  CHECK(MemoryStatistic::usage(Category::NodeTree).live == before.live + 100);
+
+  // Moving to another category leaves no bytes behind
+  a.update(Category::Caches, 100);
+  CHECK(MemoryStatistic::usage(Category::NodeTree).live == before.live);
+}
+
+TEST_CASE("MemoryStatistic leaves caches out of the total", "[MemoryStatistic]")
+{
+  const auto before = MemoryStatistic::total();
+  MemoryStatistic::Tracked geometry(Category::PolySets, 1000);
+  MemoryStatistic::Tracked entry(Category::Caches, 1000);
+  CHECK(MemoryStatistic::total().live == before.live + 1000);
+}
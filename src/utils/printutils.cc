@@ -17,7 +17,6 @@
 
 namespace fs = std::filesystem;
 
-std::set<std::string> printedDeprecations;
 std::list<std::string> print_messages_stack;
 OutputHandlerFunc *outputhandler = nullptr;
 void *outputhandler_data = nullptr;
@@ -31,6 +30,9 @@ bool OpenSCAD::rangeCheck = false;
 
 namespace {
 
+// Deprecations are only printed once per location. This is checked when printing
+// rather than when the message is made, as messages are made on worker threads too.
+std::set<std::string> printedDeprecations;
 std::list<struct Message> log_messages_stack;
 OutputHandlerFunc2 *outputhandler2 = nullptr;
 boost::circular_buffer<std::string> lastmessages(5);
@@ -39,8 +41,36 @@ boost::circular_buffer<struct Message> lastlogmessages(5);
 bool no_throw;
 bool deferred;
 
+thread_local MessageCapture *current_capture = nullptr;
+
 }  // namespace
 
+MessageCapture::MessageCapture() : previous(current_capture)
+{
+  current_capture = this;
+}
+
+MessageCapture::~MessageCapture()
+{
+  if (this->active) release();
+}
+
+std::vector<std::pair<Message, bool>> MessageCapture::release()
+{
+  assert(current_capture == this);
+  current_capture = this->previous;
+  this->active = false;
+  return std::move(this->messages);
+}
+
+void MessageCapture::replay(const std::vector<std::pair<Message, bool>>& messages)
+{
+  for (const auto& [msgObj, nocache] : messages) {
+    if (nocache) PRINT_NOCACHE(msgObj);
+    else PRINT(msgObj);
+  }
+}
+
 void set_output_handler(OutputHandlerFunc *newhandler, OutputHandlerFunc2 *newhandler2, void *userdata)
 {
   outputhandler = newhandler;
@@ -82,6 +112,14 @@ void print_messages_pop()
 void PRINT(const Message& msgObj)
 {
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
+  if (current_capture) {
+    current_capture->add(msgObj, false);
+    return;
+  }
+  if (msgObj.group == message_group::Deprecated &&
+      !printedDeprecations.insert(msgObj.msg + msgObj.loc.toRelativeString(msgObj.docPath)).second) {
+    return;
+  }
 
   if (print_messages_stack.size() > 0) {
     if (!print_messages_stack.back().empty()) {
@@ -103,6 +141,10 @@ void PRINT(const Message& msgObj)
 void PRINT_NOCACHE(const Message& msgObj)
 {
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
+  if (current_capture) {
+    current_capture->add(msgObj, true);
+    return;
+  }
 
   const auto msg = msgObj.str();
 
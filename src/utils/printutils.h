@@ -11,6 +11,7 @@
 #include <tuple>
 #include <utility>
 #include <optional>
+#include <vector>
 
 #include <libintl.h>
 // Undefine some defines from libintl.h to presolve
@@ -128,6 +129,30 @@ void resetSuppressedMessages();
 void PRINT(const Message& msgObj);
 
 void PRINT_NOCACHE(const Message& msgObj);
+
+/* Collects everything printed on the current thread while it is alive, instead
+   of outputting it. Printing is not thread-safe, so work running on other threads
+   uses this to hand its messages back to the main thread, which calls replay(). */
+class MessageCapture
+{
+public:
+  MessageCapture();
+  ~MessageCapture();
+  MessageCapture(const MessageCapture&) = delete;
+  MessageCapture& operator=(const MessageCapture&) = delete;
+
+  // Stops capturing and returns the collected messages, see replay()
+  std::vector<std::pair<Message, bool>> release();
+  static void replay(const std::vector<std::pair<Message, bool>>& messages);
+
+  void add(const Message& msgObj, bool nocache) { this->messages.emplace_back(msgObj, nocache); }
+
+private:
+  MessageCapture *previous;
+  bool active{true};
+  std::vector<std::pair<Message, bool>> messages;
+};
+
 #define PRINTB_NOCACHE(_fmt, _arg) \
   do {                             \
   } while (0)
@@ -249,21 +274,11 @@ public:
   [[nodiscard]] std::string format() const { return format(std::index_sequence_for<Ts...>{}); }
 };
 
-extern std::set<std::string> printedDeprecations;
-
 template <typename... Args>
 std::optional<Message> make_message_obj(const message_group& msgGroup, Location loc, std::string docPath,
                                         std::string&& f, Args&&...args)
 {
   auto formatted = MessageClass<Args...>{std::move(f), std::forward<Args>(args)...}.format();
-
-  // check for deprecations
-  if (msgGroup == message_group::Deprecated &&
-      printedDeprecations.find(formatted + loc.toRelativeString(docPath)) != printedDeprecations.end())
-    return {};
-  if (msgGroup == message_group::Deprecated)
-    printedDeprecations.insert(formatted + loc.toRelativeString(docPath));
-
   return std::make_optional<Message>(std::move(formatted), msgGroup, std::move(loc), std::move(docPath));
 }
 
@@ -0,0 +1,148 @@
+#include <catch2/catch_all.hpp>
+#include "core/ProgressEstimator.h"
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+#include "core/CsgOpNode.h"
+#include "core/ModuleInstantiation.h"
+#include "core/enums.h"
+#include "core/node.h"
+
+using Operation = ProgressEstimator::Operation;
+
+namespace {
+
+// difference() { a; group() { b; c; } }
+struct Tree {
+  Tree()
+  {
+    group->children = {b, c};
+    root->children = {a, group};
+  }
+
+  ModuleInstantiation mi{"test"};
+  std::shared_ptr<AbstractNode> a = std::make_shared<GroupNode>(&mi);
+  std::shared_ptr<AbstractNode> b = std::make_shared<GroupNode>(&mi);
+  std::shared_ptr<AbstractNode> c = std::make_shared<GroupNode>(&mi);
+  std::shared_ptr<AbstractNode> group = std::make_shared<GroupNode>(&mi);
+  std::shared_ptr<AbstractNode> root = std::make_shared<CsgOpNode>(&mi, OpenSCADOperator::DIFFERENCE);
+};
+
+// A clock the test advances by hand
+struct TestClock {
+  ProgressEstimator::TimeSource source()
+  {
+    return [this]() { return time; };
+  }
+  void advance(double seconds)
+  {
+    time += std::chrono::duration_cast<ProgressEstimator::Clock::duration>(
+      std::chrono::duration<double>(seconds));
+  }
+
+  ProgressEstimator::Clock::time_point time;
+};
+
+}  // namespace
+
+TEST_CASE("ProgressEstimator classifies operations", "[ProgressEstimator]")
+{
+  Tree tree;
+  CHECK(ProgressEstimator::operation(*tree.a) == Operation::Leaf);
+  CHECK(ProgressEstimator::operation(*tree.group) == Operation::Union);
+  CHECK(ProgressEstimator::operation(*tree.root) == Operation::Difference);
+  tree.group->children = {tree.b};
+  CHECK(ProgressEstimator::operation(*tree.group) == Operation::PassThrough);
+}
+
+TEST_CASE("ProgressEstimator estimates by cost until something finished", "[ProgressEstimator]")
+{
+  Tree tree;
+  TestClock clock;
+  ProgressEstimator estimator(*tree.root, clock.source());
+  clock.advance(1);
+  CHECK(estimator.remaining() < 0);
+  CHECK(estimator.fraction() == 0);
+}
+
+TEST_CASE("ProgressEstimator learns the rate of finished nodes for the ETA", "[ProgressEstimator]")
+{
+  Tree tree;
+  TestClock clock;
+  ProgressEstimator estimator(*tree.group, clock.source());
+  clock.advance(2);
+  estimator.finished(*tree.b, 100);
+
+  // 2 s for the 100 facets of b, at which rate c and the union of 200 facets are left
+  const double left = 0.02 * (100 + 200 * std::log2(202.0));
+  CHECK(estimator.remaining() == Catch::Approx(left));
+  CHECK(estimator.elapsed() == Catch::Approx(2));
+  CHECK(estimator.fraction() == Catch::Approx(2 / (2 + left)));
+}
+
+TEST_CASE("ProgressEstimator propagates actual facets to the parent's cost", "[ProgressEstimator]")
+{
+  Tree tree;
+  TestClock clock;
+  ProgressEstimator small(*tree.root, clock.source());
+  ProgressEstimator large(*tree.root, clock.source());
+  clock.advance(1);
+  small.finished(*tree.a, 10);
+  large.finished(*tree.a, 100000);
+
+  // Both learned the same rate, but the difference is far more work in large
+  REQUIRE(small.remaining() > 0);
+  CHECK(large.remaining() > 10 * small.remaining());
+}
+
+TEST_CASE("ProgressEstimator credits the parent for merging finished children", "[ProgressEstimator]")
+{
+  Tree tree;
+  TestClock clock;
+  ProgressEstimator estimator(*tree.root, clock.source());
+  clock.advance(1);
+  estimator.finished(*tree.b, 100);
+  estimator.reported(*tree.b);  // The report following the result
+  const double before = estimator.remaining();
+  REQUIRE(before > 0);
+  estimator.reported(*tree.b);  // Merged into group
+  CHECK(estimator.remaining() < before);
+}
+
+TEST_CASE("ProgressEstimator finishes descendants of cached nodes", "[ProgressEstimator]")
+{
+  Tree tree;
+  TestClock clock;
+  ProgressEstimator estimator(*tree.root, clock.source());
+  clock.advance(1);
+  estimator.finished(*tree.a, 100);
+  const double before = estimator.remaining();
+  // group came from the cache, so b and c are never rendered
+  estimator.finished(*tree.group, 200);
+  CHECK(estimator.remaining() < before);
+  estimator.finished(*tree.b, 100);  // Ignored, b is already done
+  clock.advance(1);
+  estimator.finished(*tree.root, 300);
+  CHECK(estimator.remaining() == 0);
+  CHECK(estimator.fraction() == 1);
+}
+
+TEST_CASE("ProgressEstimator finishes nodes on their first report without results",
+          "[ProgressEstimator]")
+{
+  Tree tree;
+  TestClock clock;
+  ProgressEstimator estimator(*tree.root, clock.source());
+  for (const auto& node : {tree.a, tree.b, tree.c, tree.group}) {
+    clock.advance(1);
+    estimator.reported(*node);
+  }
+  CHECK(estimator.remaining() > 0);
+  CHECK(estimator.fraction() < 1);
+  clock.advance(1);
+  estimator.reported(*tree.root);
+  CHECK(estimator.remaining() == 0);
+  CHECK(estimator.fraction() == 1);
+}
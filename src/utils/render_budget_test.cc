@@ -0,0 +1,79 @@
+#include <catch2/catch_all.hpp>
+#include "RenderBudget.h"
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include "geometry/GeometryCache.h"
+#include "geometry/PolySet.h"
+
+namespace {
+
+// Returns the exception thrown by RenderBudget::check(), or nullptr if none was thrown
+std::unique_ptr<RenderBudgetException> checkBudget()
+{
+  try {
+    RenderBudget::check();
+  } catch (const RenderBudgetException& e) {
+    return std::make_unique<RenderBudgetException>(e);
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+TEST_CASE("RenderBudget is inactive without limits", "[RenderBudget]")
+{
+  const RenderBudget::Scope scope({}, "");
+  CHECK_FALSE(RenderBudget::enabled());
+  CHECK(!checkBudget());
+}
+
+TEST_CASE("RenderBudget throws once the time is up", "[RenderBudget]")
+{
+  RenderBudget::Limits limits;
+  limits.max_time = 0.001;
+  const RenderBudget::Scope scope(limits, "");
+  REQUIRE(RenderBudget::enabled());
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+  const auto e = checkBudget();
+  REQUIRE(e);
+  CHECK(e->resource == "time");
+  CHECK(e->limit == 1);
+  CHECK(e->used >= 5);
+}
+
+TEST_CASE("RenderBudget keeps the caches within the memory limit", "[RenderBudget]")
+{
+  auto *cache = GeometryCache::instance();
+  cache->insert("render_budget_test", std::make_shared<PolySet>(3));
+  REQUIRE(cache->contains("render_budget_test"));
+
+  RenderBudget::Limits limits;
+  limits.max_memory = std::numeric_limits<size_t>::max() / 2;
+  const RenderBudget::Scope scope(limits, "");
+  CHECK(!checkBudget());
+  CHECK(cache->contains("render_budget_test"));
+  cache->clear();
+}
+
+TEST_CASE("RenderBudget sheds the caches before exceeding the memory limit", "[RenderBudget]")
+{
+  auto *cache = GeometryCache::instance();
+  cache->insert("render_budget_test", std::make_shared<PolySet>(3));
+  REQUIRE(cache->contains("render_budget_test"));
+
+  RenderBudget::Limits limits;
+  limits.max_memory = 1;
+  const RenderBudget::Scope scope(limits, "");
+  const auto e = checkBudget();
+  REQUIRE(e);
+  CHECK(e->resource == "memory");
+  CHECK(e->limit == 1);
+  CHECK(e->used > 1);
+  CHECK_FALSE(cache->contains("render_budget_test"));
+}
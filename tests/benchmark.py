@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+
+# Runs the benchmark suite and compares its results against a stored baseline
+#
+# Usage: <script> --openscad=<executable> [--unittests=<OpenSCADUnitTests>]
+#                 [--output=<results.json>] [--baseline=<baseline.json>] [--threshold=<fraction>]
+#                 [--repeat=<n>] [--filter=<regex>] [--update-baseline]
+#
+# Micro benchmarks are the hidden unit test cases tagged [benchmark] (see src/*/*_benchmark_test.cc,
+# and others next to the unit tests of what they measure). They must time their code with
+# Catch2's BENCHMARK, since their mean time per run is taken from the Catch2 XML report.
+# Macro benchmarks render the models in data/scad/benchmark and some examples with each 3D
+# backend, keeping the fastest of --repeat runs. The options and output format of a benchmark
+# model are taken from the "openscad ... -o out.<ext> <model>.scad" line in its header comment,
+# and the inputs it imports are generated from the "generate-*.py <file> ..." line if missing.
+#
+# Results are written as JSON, with all times in seconds:
+#   {"benchmarks": {"<name>": {"seconds": <time>}, ...}, "failed": ["<name>", ...]}
+#
+# A benchmark regresses if it is slower than in the baseline by more than the threshold, a
+# fraction of the baseline time. A baseline entry can override the threshold with its own
+# "threshold". The baseline is machine specific; create or refresh it with --update-baseline,
+# which keeps the thresholds of entries already in the baseline.
+#
+# This script returns 0 on success, 1 if a benchmark regressed or failed.
+#
+
+import sys, os, re, subprocess, argparse, json, glob, shutil, statistics, tempfile, time
+import xml.etree.ElementTree as ET
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+BENCHMARK_DIR = os.path.join(TESTS_DIR, "data", "scad", "benchmark")
+
+# Examples rendered as macro benchmarks, relative to the examples directory
+EXAMPLES = [
+    "Basics/CSG.scad",
+    "Basics/logo.scad",
+    "Basics/rotate_extrude.scad",
+    "Advanced/module_recursion.scad",
+    "Parametric/candleStand.scad",
+]
+
+BACKENDS = ["manifold", "cgal"]
+
+
+def benchmark_command(scadfile):
+    """Returns the openscad options and output suffix from the header comment of a model."""
+    with open(scadfile) as f:
+        for line in f:
+            if not line.startswith("//"):
+                break
+            m = re.match(r"//\s+openscad\s+(.*)-o\s+\S+\.(\w+)\s+\S+\.scad\s*$", line)
+            if m:
+                options = [o for o in m.group(1).split() if not o.startswith("--backend")]
+                return options, m.group(2)
+    return [], "stl"
+
+
+def generate_inputs(scadfile):
+    """Runs the generator scripts named in the header comment of a model, for missing outputs."""
+    with open(scadfile) as f:
+        for line in f:
+            if not line.startswith("//"):
+                break
+            m = re.match(r"//\s+(generate-\S+\.py)\s+(\S+)(.*)$", line)
+            if m and not os.path.exists(os.path.join(BENCHMARK_DIR, m.group(2))):
+                print("Generating " + m.group(2))
+                subprocess.check_call([sys.executable, m.group(1), m.group(2)] + m.group(3).split(),
+                                      cwd=BENCHMARK_DIR)
+
+
+def macro_benchmarks(args):
+    models = [(os.path.relpath(f, TESTS_DIR), f)
+              for f in sorted(glob.glob(os.path.join(BENCHMARK_DIR, "*.scad")))]
+    if args.examples:
+        models += [("examples/" + f, os.path.join(args.examples, f)) for f in EXAMPLES]
+    for name, scadfile in models:
+        for backend in BACKENDS:
+            yield "render/" + name + "/" + backend, scadfile, backend
+
+
+def run_macro(args, scadfile, backend, outdir):
+    options, suffix = benchmark_command(scadfile)
+    generate_inputs(scadfile)
+    outfile = os.path.join(outdir, "out." + suffix)
+    cmd = [args.openscad, "--backend=" + backend] + options + ["-o", outfile, scadfile]
+    times = []
+    for _ in range(args.repeat):
+        start = time.perf_counter()
+        proc = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        times.append(time.perf_counter() - start)
+        if proc.returncode != 0:
+            sys.stderr.write(proc.stderr.decode(errors="replace"))
+            return None
+    return {"seconds": min(times), "median": statistics.median(times), "runs": len(times)}
+
+
+def micro_benchmarks(args):
+    """Runs the [benchmark] unit tests, returning {name: result} parsed from the XML report."""
+    cmd = [args.unittests, "[benchmark]", "--reporter", "xml",
+           "--benchmark-samples", str(args.samples)]
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE)
+    results = {}
+    try:
+        report = ET.fromstring(proc.stdout)
+    except ET.ParseError:
+        return {"micro/[benchmark]": None}
+    for benchmark in report.iter("BenchmarkResults"):
+        mean = benchmark.find("mean")
+        results["micro/" + benchmark.get("name")] = {
+            "seconds": float(mean.get("value")) * 1e-9,
+            "lower": float(mean.get("lowerBound")) * 1e-9,
+            "upper": float(mean.get("upperBound")) * 1e-9,
+        }
+    if proc.returncode != 0:
+        results["micro/[benchmark]"] = None
+    return results
+
+
+def compare(results, baseline, threshold):
+    """Prints each benchmark against its baseline, returning the names of the regressed ones."""
+    regressed = []
+    for name in sorted(results["benchmarks"]):
+        seconds = results["benchmarks"][name]["seconds"]
+        base = baseline.get("benchmarks", {}).get(name)
+        if not base:
+            print("%-70s %10.4fs (new)" % (name, seconds))
+            continue
+        limit = base.get("threshold", threshold)
+        change = seconds / base["seconds"] - 1
+        status = ""
+        if change > limit:
+            status = " REGRESSION (threshold %+.0f%%)" % (limit * 100)
+            regressed.append(name)
+        print("%-70s %10.4fs %+7.1f%%%s" % (name, seconds, change * 100, status))
+    for name in results["failed"]:
+        print("%-70s FAILED" % name)
+    return regressed
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument(
+    "--openscad",
+    default=os.environ.get("OPENSCAD_BINARY"),
+    help='Specify OpenSCAD executable, default to env["OPENSCAD_BINARY"] if absent.',
+)
+parser.add_argument("--unittests", help="OpenSCADUnitTests executable, to run the micro benchmarks")
+parser.add_argument("--examples", help="Examples directory, to render examples as benchmarks")
+parser.add_argument("--output", default="benchmark-results.json", help="Results file to write")
+parser.add_argument("--baseline", help="Baseline results file to compare against")
+parser.add_argument("--threshold", type=float, default=0.15,
+                    help="Allowed slowdown relative to the baseline, as a fraction (default 0.15)")
+parser.add_argument("--repeat", type=int, default=3, help="Renders of each model (default 3)")
+parser.add_argument("--samples", type=int, default=20, help="Samples of each micro benchmark")
+parser.add_argument("--filter", default="", help="Only run benchmarks whose name matches this regex")
+parser.add_argument("--update-baseline", action="store_true",
+                    help="Write the results to the baseline file instead of comparing")
+args = parser.parse_args()
+
+if not args.openscad or not os.path.exists(args.openscad):
+    print("cant find openscad executable named: " + str(args.openscad))
+    sys.exit(1)
+
+results = {"benchmarks": {}, "failed": []}
+pattern = re.compile(args.filter)
+
+if args.unittests:
+    for name, result in micro_benchmarks(args).items():
+        if not pattern.search(name):
+            continue
+        if result is None:
+            results["failed"].append(name)
+        else:
+            results["benchmarks"][name] = result
+
+outdir = tempfile.mkdtemp(prefix="openscad-benchmark-")
+try:
+    for name, scadfile, backend in macro_benchmarks(args):
+        if not pattern.search(name):
+            continue
+        print("Running " + name)
+        result = run_macro(args, scadfile, backend, outdir)
+        if result is None:
+            results["failed"].append(name)
+        else:
+            results["benchmarks"][name] = result
+finally:
+    shutil.rmtree(outdir)
+
+with open(args.output, "w") as f:
+    json.dump(results, f, indent=1, sort_keys=True)
+print("Results written to " + args.output)
+
+if args.update_baseline:
+    if not args.baseline:
+        print("--update-baseline requires --baseline")
+        sys.exit(1)
+    # Keep the per-entry thresholds of the previous baseline
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            previous = json.load(f).get("benchmarks", {})
+        for name, result in results["benchmarks"].items():
+            if "threshold" in previous.get(name, {}):
+                result["threshold"] = previous[name]["threshold"]
+    with open(args.baseline, "w") as f:
+        json.dump({"benchmarks": results["benchmarks"]}, f, indent=1, sort_keys=True)
+    print("Baseline written to " + args.baseline)
+    sys.exit(1 if results["failed"] else 0)
+
+baseline = {}
+if args.baseline and os.path.exists(args.baseline):
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+elif args.baseline:
+    print("No baseline at " + args.baseline + ", run with --update-baseline to create one")
+
+regressed = compare(results, baseline, args.threshold)
+if regressed or results["failed"]:
+    print("%d benchmarks regressed, %d failed" % (len(regressed), len(results["failed"])))
+    sys.exit(1)
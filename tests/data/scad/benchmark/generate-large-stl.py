@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+
+# Generates a large binary STL (a finely tessellated torus) for import benchmarks.
+#
+# Usage: <script> <output.stl> [<number of rings>]
+#
+# Each ring contributes 2 * rings triangles, so the default of 1000 rings gives
+# two million triangles. Every vertex is shared by six triangles, as in typical
+# exported meshes, so import time is dominated by vertex welding.
+
+import sys, math, struct
+
+
+def main():
+    out = sys.argv[1]
+    rings = int(sys.argv[2]) if len(sys.argv) > 2 else 1000
+    segments = rings
+
+    def vertex(i, j):
+        phi = 2 * math.pi * (i % rings) / rings
+        theta = 2 * math.pi * (j % segments) / segments
+        r = 10 + 3 * math.cos(theta)
+        return (r * math.cos(phi), r * math.sin(phi), 3 * math.sin(theta))
+
+    with open(out, "wb") as f:
+        f.write(b"torus".ljust(80, b" "))
+        f.write(struct.pack("<I", 2 * rings * segments))
+        for i in range(rings):
+            for j in range(segments):
+                a, b = vertex(i, j), vertex(i + 1, j)
+                c, d = vertex(i + 1, j + 1), vertex(i, j + 1)
+                for tri in ((a, b, c), (a, c, d)):
+                    f.write(struct.pack("<12fH", 0, 0, 0, *tri[0], *tri[1], *tri[2], 0))
+
+
+if __name__ == "__main__":
+    main()
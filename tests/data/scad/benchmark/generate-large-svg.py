@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+
+# Generates a synthetic laser-cut style SVG for import benchmarks.
+#
+# Usage: <script> <output.svg> [<number of paths>]
+#
+# Every path is a closed outline mixing line, cubic, quadratic and arc
+# segments in compact path data notation (relative commands, implicit
+# separators), similar to what drawing programs export.
+
+import sys, math, random
+
+
+def path_data(rnd, x, y, r):
+    d = ["M%.3f,%.3f" % (x + r, y)]
+    segments = rnd.randint(6, 12)
+    for i in range(1, segments + 1):
+        a = 2 * math.pi * i / segments
+        px, py = x + r * math.cos(a), y + r * math.sin(a)
+        kind = i % 4
+        if kind == 0:
+            d.append("L%.3f %.3f" % (px, py))
+        elif kind == 1:
+            d.append("C%.3f,%.3f %.3f,%.3f %.3f,%.3f" % (px - 0.3, py + 0.2, px + 0.2, py - 0.3, px, py))
+        elif kind == 2:
+            d.append("Q%.3f-%.3f %.3f %.3f" % (px + 0.25, abs(py) + 0.1, px, py))
+        else:
+            d.append("A%.2f %.2f 0 0 1 %.3f %.3f" % (r / 3, r / 3, px, py))
+    d.append("z")
+    return "".join(d)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: %s <output.svg> [<number of paths>]" % sys.argv[0], file=sys.stderr)
+        return 1
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 20000
+    cols = int(math.ceil(math.sqrt(count)))
+    rnd = random.Random(42)
+    with open(sys.argv[1], "w") as f:
+        size = cols * 10
+        f.write('<?xml version="1.0" encoding="UTF-8"?>\n')
+        f.write('<svg xmlns="http://www.w3.org/2000/svg" width="%dmm" height="%dmm" viewBox="0 0 %d %d">\n'
+                % (size, size, size, size))
+        f.write('<g fill="none" stroke="#000" stroke-width="0.1">\n')
+        for i in range(count):
+            x = (i % cols) * 10 + 5
+            y = (i // cols) * 10 + 5
+            f.write('<path id="p%d" d="%s"/>\n' % (i, path_data(rnd, x, y, rnd.uniform(2, 4.5))))
+        f.write('</g>\n</svg>\n')
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())